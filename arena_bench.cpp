@@ -0,0 +1,99 @@
+// Counts heap allocations and times small solves: the K-map engine on 2- to
+// 6-variable functions through kmapWordCover(), whose primes, cover and scratch
+// all live in the thread's cube arena, and whole KMapSolver solves for
+// comparison, which also build the SolveResult snapshot. Each batch is solved
+// twice; the second pass runs with a warm arena and NPN cache.
+//
+// Usage: arena_bench [functions per batch, default 20000]
+#include "kmap_solver.hpp"
+#include "cube_arena.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+
+namespace {
+
+std::atomic<size_t> allocations{0};
+
+struct Function {
+    uint64_t onSet, dontCares;
+};
+
+vector<Function> batch(int varCount, bool withDontCares, size_t count, std::mt19937_64& random) {
+    uint64_t full = variableMask(1 << varCount);
+    vector<Function> functions;
+    while (functions.size() < count) {
+        uint64_t onSet = random() & full;
+        uint64_t dontCares = withDontCares ? random() & random() & full & ~onSet : 0;
+        functions.push_back({onSet, dontCares});
+    }
+    return functions;
+}
+
+struct Pass {
+    double us;          // per function
+    double allocations; // per function
+};
+
+template <typename Solve>
+Pass measure(const vector<Function>& functions, Solve&& solve) {
+    using Clock = std::chrono::steady_clock;
+    size_t before = allocations.load(), sink = 0;
+    Clock::time_point start = Clock::now();
+    for (const Function& function : functions) sink += solve(function);
+    double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / functions.size();
+    // Keep the results observable so the solves are not optimized away
+    if (sink == size_t(-1)) std::puts("");
+    return {us, double(allocations.load() - before) / functions.size()};
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+int main(int argc, char* argv[]) {
+    long count = argc > 1 ? std::atol(argv[1]) : 20000;
+    if (count <= 0) {
+        std::fprintf(stderr, "Usage: %s [functions per batch]\n", argv[0]);
+        return 1;
+    }
+
+    std::printf("%-22s %12s %12s %12s %12s %12s\n", "batch", "cold allocs", "warm allocs", "warm us",
+                "solver allocs", "solver us");
+    std::mt19937_64 random(12345);
+    for (int varCount = 2; varCount <= kMaxWordVariables; varCount++) {
+        for (bool withDontCares : {false, true}) {
+            vector<Function> functions = batch(varCount, withDontCares, count, random);
+            auto engine = [&](const Function& function) -> size_t {
+                CubeArenaScope scope;
+                CubeList primes(scope.arena), cover(scope.arena);
+                bool proven = false;
+                size_t bound = 0;
+                kmapWordCover(function.onSet, function.dontCares, varCount, primes, cover, proven, bound);
+                return cover.size() + primes.size();
+            };
+            auto solver = [&](const Function& function) -> size_t {
+                KMapSolver solver(&function.onSet, varCount, withDontCares ? &function.dontCares : nullptr);
+                solver.setEngine(MinimizerEngine::KMap);
+                return solver.getResult()->cover.size();
+            };
+            Pass cold = measure(functions, engine);
+            Pass warm = measure(functions, engine);
+            Pass whole = measure(functions, solver);
+            char name[32];
+            std::snprintf(name, sizeof(name), "%d vars%s", varCount, withDontCares ? ", don't-cares" : "");
+            std::printf("%-22s %12.2f %12.2f %12.2f %12.1f %12.2f\n", name, cold.allocations, warm.allocations,
+                        warm.us, whole.allocations, whole.us);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,310 @@
+#include "bdd.hpp"
+#include "cover_solver.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+// The computed table grows with the unique table up to this many entries
+static const size_t kMaxAndCacheSize = size_t(1) << 20;
+// Nodes that all sifting trials together may allocate before the order is kept as is
+static const size_t kSiftingNodeBudget = size_t(1) << 24;
+
+static inline uint64_t hashTriple(uint64_t a, uint64_t b, uint64_t c) {
+    uint64_t h = a * 0x9E3779B97F4A7C15ull;
+    h ^= b + 0xBF58476D1CE4E5B9ull + (h << 6) + (h >> 2);
+    h ^= c + 0x94D049BB133111EBull + (h << 6) + (h >> 2);
+    return h ^ (h >> 31);
+}
+
+Bdd::Bdd(const vector<int>& levelBits)
+    : levelBits(levelBits), bitLevels(64, 0), unique(1024, 0), andCache(1024, CacheEntry{0, 0, 0}),
+      nodeLimit(std::numeric_limits<size_t>::max()) {
+    for (size_t level = 0; level < levelBits.size(); level++) bitLevels[levelBits[level]] = level;
+    // Terminal: the constant one, below every variable level
+    nodes.push_back({static_cast<uint32_t>(levelBits.size()), One, One});
+}
+
+void Bdd::growUniqueTable() {
+    vector<uint32_t> grown(unique.size() * 2, 0);
+    size_t mask = grown.size() - 1;
+    for (uint32_t slot : unique) {
+        if (!slot) continue;
+        const Node& n = nodes[slot - 1];
+        size_t i = hashTriple(n.level, n.low, n.high) & mask;
+        while (grown[i]) i = (i + 1) & mask;
+        grown[i] = slot;
+    }
+    unique.swap(grown);
+    if (andCache.size() < std::min(unique.size(), kMaxAndCacheSize)) {
+        andCache.assign(std::min(unique.size(), kMaxAndCacheSize), CacheEntry{0, 0, 0});
+    }
+}
+
+Bdd::Ref Bdd::makeNode(uint32_t level, Ref low, Ref high) {
+    if (low == high) return low;
+    // Keep the then edge regular; push its complement onto the result
+    Ref complement = high & 1;
+    low ^= complement;
+    high ^= complement;
+
+    size_t mask = unique.size() - 1;
+    size_t i = hashTriple(level, low, high) & mask;
+    while (unique[i]) {
+        const Node& n = nodes[unique[i] - 1];
+        if (n.level == level && n.low == low && n.high == high) return ((unique[i] - 1) << 1) | complement;
+        i = (i + 1) & mask;
+    }
+    if (nodes.size() >= nodeLimit) throw BddNodeLimitExceeded();
+    checkBudget();
+    nodes.push_back({level, low, high});
+    unique[i] = static_cast<uint32_t>(nodes.size());
+    if (nodes.size() * 2 > unique.size()) growUniqueTable();
+    return ((static_cast<Ref>(nodes.size()) - 1) << 1) | complement;
+}
+
+void Bdd::checkBudget() {
+    if (budget && ++sinceBudgetCheck >= kBudgetCheckInterval) {
+        sinceBudgetCheck = 0;
+        if (!budget->spend()) throw SolveBudgetExpired();
+    }
+}
+
+Bdd::Ref Bdd::variable(int bit) {
+    return makeNode(bitLevels[bit], Zero, One);
+}
+
+Bdd::Ref Bdd::cube(const Cube& c) {
+    // Build bottom-up so every node is created once
+    Ref result = One;
+    for (int level = static_cast<int>(levelBits.size()) - 1; level >= 0; level--) {
+        uint64_t bit = uint64_t(1) << levelBits[level];
+        if (!(c.mask & bit)) continue;
+        result = (c.value & bit) ? makeNode(level, Zero, result) : makeNode(level, result, Zero);
+    }
+    return result;
+}
+
+Bdd::Ref Bdd::fromCubes(const vector<Cube>& cubes) {
+    // Pairwise OR keeps intermediate results balanced
+    vector<Ref> layer;
+    layer.reserve(cubes.size());
+    for (const Cube& c : cubes) layer.push_back(cube(c));
+    if (layer.empty()) return Zero;
+    while (layer.size() > 1) {
+        vector<Ref> next;
+        for (size_t i = 0; i + 1 < layer.size(); i += 2) next.push_back(bddOr(layer[i], layer[i + 1]));
+        if (layer.size() % 2) next.push_back(layer.back());
+        layer.swap(next);
+    }
+    return layer[0];
+}
+
+Bdd::Ref Bdd::bddAnd(Ref f, Ref g) {
+    if (f == Zero || g == Zero || f == negate(g)) return Zero;
+    if (f == One || f == g) return g;
+    if (g == One) return f;
+    if (f > g) std::swap(f, g);
+
+    // Both operands are internal nodes here, so an empty (0, 0) entry never matches
+    size_t slot = hashTriple(f, g, 0) & (andCache.size() - 1);
+    if (andCache[slot].f == f && andCache[slot].g == g) return andCache[slot].result;
+
+    uint32_t level = std::min(levelOf(f), levelOf(g));
+    Ref f0 = levelOf(f) == level ? lowOf(f) : f, f1 = levelOf(f) == level ? highOf(f) : f;
+    Ref g0 = levelOf(g) == level ? lowOf(g) : g, g1 = levelOf(g) == level ? highOf(g) : g;
+    Ref result = makeNode(level, bddAnd(f0, g0), bddAnd(f1, g1));
+
+    // Recursion may have resized the cache
+    andCache[hashTriple(f, g, 0) & (andCache.size() - 1)] = {f, g, result};
+    return result;
+}
+
+double Bdd::satCount(Ref f) const {
+    // Density of ones under each node; a complemented edge takes 1 - density
+    vector<double> density(nodes.size(), -1.0);
+    density[0] = 1.0;
+    std::function<double(Ref)> visit = [&](Ref r) {
+        uint32_t n = r >> 1;
+        if (density[n] < 0) density[n] = (visit(nodes[n].low) + visit(nodes[n].high)) / 2;
+        return (r & 1) ? 1.0 - density[n] : density[n];
+    };
+    return std::ldexp(visit(f), static_cast<int>(levelBits.size()));
+}
+
+void Bdd::collectMinterms(Ref f, vector<uint64_t>& out) const {
+    collectMinterms(f, 0, 0, out);
+}
+
+void Bdd::collectMinterms(Ref f, uint32_t level, uint64_t prefix, vector<uint64_t>& out) const {
+    if (f == Zero) return;
+    if (level == levelBits.size()) {
+        out.push_back(prefix);
+        return;
+    }
+    uint64_t bit = uint64_t(1) << levelBits[level];
+    collectMinterms(cofactor(f, level, false), level + 1, prefix, out);
+    collectMinterms(cofactor(f, level, true), level + 1, prefix | bit, out);
+}
+
+bool Bdd::pickMinterm(Ref f, uint64_t& minterm) const {
+    if (f == Zero) return false;
+    minterm = 0;
+    // Every node of a reduced BDD has a satisfiable child, so the walk ends at One
+    while (f != One) {
+        Ref high = highOf(f);
+        if (high != Zero) {
+            minterm |= uint64_t(1) << levelBits[levelOf(f)];
+            f = high;
+        } else {
+            f = lowOf(f);
+        }
+    }
+    return true;
+}
+
+size_t Bdd::countNodes(Ref f) const {
+    vector<char> seen(nodes.size(), 0);
+    vector<uint32_t> stack(1, f >> 1);
+    size_t count = 0;
+    while (!stack.empty()) {
+        uint32_t n = stack.back();
+        stack.pop_back();
+        if (seen[n]) continue;
+        seen[n] = 1;
+        count++;
+        if (n != 0) {
+            stack.push_back(nodes[n].low >> 1);
+            stack.push_back(nodes[n].high >> 1);
+        }
+    }
+    return count;
+}
+
+vector<Cube> Bdd::isop(Ref f) {
+    return isop(f, f);
+}
+
+vector<Cube> Bdd::isop(Ref lower, Ref upper) {
+    isopNodes.assign(2, IsopNode{Zero, 0, kEmptyCover, kEmptyCover, kEmptyCover});
+    isopNodes[kUnitCover].function = One;
+    isopCache.clear();
+    vector<Cube> cover;
+    collectCubes(isopCover(lower, upper), Cube{0, 0}, cover);
+    return cover;
+}
+
+// Minato-Morreale: an irredundant cover C with lower <= C <= upper. Sub-covers
+// are shared through the memo and only expanded into cubes at the end.
+uint32_t Bdd::isopCover(Ref lower, Ref upper) {
+    if (lower == Zero) return kEmptyCover;
+    if (upper == One) return kUnitCover;
+
+    uint64_t key = (uint64_t(lower) << 32) | upper;
+    auto cached = isopCache.find(key);
+    if (cached != isopCache.end()) return cached->second;
+    checkBudget();
+
+    uint32_t level = std::min(levelOf(lower), levelOf(upper));
+    Ref l0 = levelOf(lower) == level ? lowOf(lower) : lower, l1 = levelOf(lower) == level ? highOf(lower) : lower;
+    Ref u0 = levelOf(upper) == level ? lowOf(upper) : upper, u1 = levelOf(upper) == level ? highOf(upper) : upper;
+
+    // Minterms that need x' (resp. x) because the other half cannot take them
+    uint32_t neg = isopCover(bddAnd(l0, negate(u1)), u0);
+    uint32_t pos = isopCover(bddAnd(l1, negate(u0)), u1);
+    Ref negFunction = isopNodes[neg].function, posFunction = isopNodes[pos].function;
+    // What is left can be covered independently of x
+    Ref rest = bddOr(bddAnd(l0, negate(negFunction)), bddAnd(l1, negate(posFunction)));
+    uint32_t shared = isopCover(rest, bddAnd(u0, u1));
+
+    Ref function = bddOr(makeNode(level, negFunction, posFunction), isopNodes[shared].function);
+    isopNodes.push_back({function, level, neg, pos, shared});
+    uint32_t index = static_cast<uint32_t>(isopNodes.size() - 1);
+    isopCache[key] = index;
+    return index;
+}
+
+void Bdd::collectCubes(uint32_t cover, Cube prefix, vector<Cube>& out) const {
+    if (cover == kEmptyCover) return;
+    if (cover == kUnitCover) {
+        out.push_back(prefix);
+        return;
+    }
+    const IsopNode& node = isopNodes[cover];
+    uint64_t bit = uint64_t(1) << levelBits[node.level];
+    collectCubes(node.neg, Cube{prefix.mask | bit, prefix.value}, out);
+    collectCubes(node.pos, Cube{prefix.mask | bit, prefix.value | bit}, out);
+    collectCubes(node.shared, prefix, out);
+}
+
+// Nodes of the BDD of `cubes` under `order`, or SIZE_MAX if it would not fit in `limit`;
+// `allocated` accumulates the nodes the attempt created. Throws SolveBudgetExpired
+// once `budget` runs out.
+static size_t sizeUnderOrder(const vector<Cube>& cubes, const vector<int>& order, size_t limit, size_t& allocated,
+                             SolveBudget* budget) {
+    Bdd bdd(order);
+    bdd.setNodeLimit(limit);
+    bdd.setBudget(budget);
+    try {
+        size_t size = bdd.countNodes(bdd.fromCubes(cubes));
+        allocated += bdd.nodeCount();
+        return size;
+    } catch (const BddNodeLimitExceeded&) {
+        allocated += bdd.nodeCount();
+        return std::numeric_limits<size_t>::max();
+    }
+}
+
+vector<int> siftVariableOrder(const vector<Cube>& cubes, int varCount, SolveBudget* budget) {
+    // Start from the natural order: the first variable (highest bit) at the root
+    vector<int> order(varCount);
+    for (int level = 0; level < varCount; level++) order[level] = varCount - 1 - level;
+    if (varCount < 3) return order;
+
+    size_t allocated = 0;
+    size_t best;
+    try {
+        best = sizeUnderOrder(cubes, order, kSiftingNodeBudget, allocated, budget);
+    } catch (const SolveBudgetExpired&) {
+        return order;
+    }
+    if (best == std::numeric_limits<size_t>::max()) return order;
+
+    // Sift the busiest variables first
+    vector<int> occurrences(varCount, 0);
+    for (const Cube& c : cubes) {
+        for (uint64_t bits = c.mask; bits; bits &= bits - 1) occurrences[__builtin_ctzll(bits)]++;
+    }
+    vector<int> byActivity(order);
+    std::stable_sort(byActivity.begin(), byActivity.end(),
+                     [&](int a, int b) { return occurrences[a] > occurrences[b]; });
+
+    for (int bit : byActivity) {
+        if (occurrences[bit] == 0) continue;
+        vector<int> rest;
+        for (int b : order) {
+            if (b != bit) rest.push_back(b);
+        }
+        vector<int> bestOrder = order;
+        for (int level = 0; level < varCount; level++) {
+            vector<int> candidate(rest);
+            candidate.insert(candidate.begin() + level, bit);
+            if (candidate == order) continue;
+            if (allocated >= kSiftingNodeBudget || (budget && !budget->spend())) return bestOrder;
+            // The limit counts intermediate nodes too, so leave generous slack
+            size_t limit = std::min(best * 4, kSiftingNodeBudget - allocated);
+            size_t size;
+            try {
+                size = sizeUnderOrder(cubes, candidate, limit, allocated, budget);
+            } catch (const SolveBudgetExpired&) {
+                return bestOrder;
+            }
+            if (size < best) {
+                best = size;
+                bestOrder = candidate;
+            }
+        }
+        order = bestOrder;
+    }
+    return order;
+}
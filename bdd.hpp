@@ -0,0 +1,119 @@
+#ifndef BDD_HPP
+#define BDD_HPP
+
+#include "truth_table.hpp"
+#include <stdexcept>
+#include <unordered_map>
+
+class SolveBudget;
+
+// Nodes a BDD or ZDD manager builds between two checks of its solve budget
+const uint32_t kBudgetCheckInterval = 4096;
+
+// Thrown when an operation would grow the manager past its node limit
+class BddNodeLimitExceeded : public std::runtime_error {
+public:
+    BddNodeLimitExceeded() : std::runtime_error("BDD node limit exceeded") {}
+};
+
+// Reduced ordered BDD manager with complement edges. A reference is a node index
+// shifted left by one with the low bit marking a complemented edge; the high
+// (then) edge of a stored node is never complemented, which keeps the
+// representation canonical. Node 0 is the constant one.
+class Bdd {
+public:
+    typedef uint32_t Ref;
+    static constexpr Ref One = 0;
+    static constexpr Ref Zero = 1;
+
+    // levelBits[level] is the minterm bit tested at that level; level 0 is the root
+    explicit Bdd(const vector<int>& levelBits);
+
+    Ref variable(int bit);
+    Ref cube(const Cube& cube);
+    Ref fromCubes(const vector<Cube>& cubes);
+
+    // Level tested at the root of f (the variable count for constants) and the
+    // cofactors of f with respect to `level`, which must not lie below the root
+    uint32_t topLevel(Ref f) const { return levelOf(f); }
+    Ref cofactor(Ref f, uint32_t level, bool value) const {
+        if (levelOf(f) != level) return f;
+        return value ? highOf(f) : lowOf(f);
+    }
+    // Node testing `level`; both children must lie below it
+    Ref branch(uint32_t level, Ref low, Ref high) { return makeNode(level, low, high); }
+
+    static Ref negate(Ref f) { return f ^ 1; }
+    Ref bddAnd(Ref f, Ref g);
+    Ref bddOr(Ref f, Ref g) { return negate(bddAnd(negate(f), negate(g))); }
+    Ref bddXor(Ref f, Ref g) { return bddOr(bddAnd(f, negate(g)), bddAnd(negate(f), g)); }
+
+    // Irredundant sum of products of f (Minato-Morreale), computed on the graph;
+    // the second form may take any cover between `lower` and `upper`
+    vector<Cube> isop(Ref f);
+    vector<Cube> isop(Ref lower, Ref upper);
+
+    // Number of satisfying minterms, and the minterms themselves
+    double satCount(Ref f) const;
+    void collectMinterms(Ref f, vector<uint64_t>& out) const;
+    // One satisfying minterm, taking the then branch where it is satisfiable and
+    // leaving skipped variables zero; false when f is Zero
+    bool pickMinterm(Ref f, uint64_t& minterm) const;
+
+    // Nodes reachable from f (terminal included) and nodes allocated overall
+    size_t countNodes(Ref f) const;
+    size_t nodeCount() const { return nodes.size(); }
+    void setNodeLimit(size_t limit) { nodeLimit = limit; }
+    // Every kBudgetCheckInterval nodes or ISOP sub-covers built spend a step of
+    // `budget`; once it runs out, operations throw SolveBudgetExpired
+    void setBudget(SolveBudget* budget) { this->budget = budget; }
+
+    const vector<int>& getLevelBits() const { return levelBits; }
+
+private:
+    struct Node {
+        uint32_t level;
+        Ref low, high;
+    };
+    struct CacheEntry {
+        Ref f, g, result;
+    };
+    // ISOP result: x' * neg + x * pos + shared, each an index into isopNodes
+    // (kEmptyCover and kUnitCover are the constant covers)
+    struct IsopNode {
+        Ref function;
+        uint32_t level;
+        uint32_t neg, pos, shared;
+    };
+    static const uint32_t kEmptyCover = 0;
+    static const uint32_t kUnitCover = 1;
+
+    uint32_t levelOf(Ref f) const { return nodes[f >> 1].level; }
+    Ref lowOf(Ref f) const { return nodes[f >> 1].low ^ (f & 1); }
+    Ref highOf(Ref f) const { return nodes[f >> 1].high ^ (f & 1); }
+    Ref makeNode(uint32_t level, Ref low, Ref high);
+    void growUniqueTable();
+    void checkBudget();
+    void collectMinterms(Ref f, uint32_t level, uint64_t prefix, vector<uint64_t>& out) const;
+    uint32_t isopCover(Ref lower, Ref upper);
+    void collectCubes(uint32_t cover, Cube prefix, vector<Cube>& out) const;
+
+    vector<int> levelBits;
+    vector<uint32_t> bitLevels; // inverse of levelBits
+    vector<Node> nodes;
+    vector<uint32_t> unique;    // open addressing, node index + 1 (0 = empty)
+    vector<CacheEntry> andCache; // direct mapped computed table for AND
+    vector<IsopNode> isopNodes;
+    std::unordered_map<uint64_t, uint32_t> isopCache;
+    size_t nodeLimit;
+    SolveBudget* budget = nullptr;
+    uint32_t sinceBudgetCheck = 0;
+};
+
+// Variable order (levelBits) for the function given by cubes, found by sifting:
+// each variable in turn is moved through every level and left where the BDD is
+// smallest. Candidate orders are evaluated by rebuilding under a node limit,
+// each spending a step of `budget`; the best order so far is kept once it runs out.
+vector<int> siftVariableOrder(const vector<Cube>& cubes, int varCount, SolveBudget* budget = nullptr);
+
+#endif // BDD_HPP
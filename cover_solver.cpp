@@ -0,0 +1,399 @@
+#include "cover_solver.hpp"
+#include <algorithm>
+#include <limits>
+#include <queue>
+
+// Bit-matrix dominance checks are quadratic; skip them on tables larger than this
+static const size_t kDominanceBudget = size_t(1) << 26;
+// Larger tables are only covered greedily
+static const size_t kMatrixBitLimit = size_t(1) << 28;
+
+SolveBudget::SolveBudget(uint64_t deadlineMs, uint64_t stepLimit)
+    : deadline(std::chrono::steady_clock::now() + std::chrono::milliseconds(deadlineMs)),
+      hasDeadline(deadlineMs > 0), stepLimit(stepLimit) {}
+
+bool SolveBudget::spend(uint64_t steps) {
+    if (expired()) return false;
+    uint64_t total = used.fetch_add(steps, std::memory_order_relaxed) + steps;
+    if ((stepLimit && total > stepLimit) || (hasDeadline && std::chrono::steady_clock::now() >= deadline)) {
+        out.store(true, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+namespace {
+
+// Rows and columns are both stored as bitsets so dominance is a word-wise subset test
+class CoverTable {
+public:
+    CoverTable(const vector<vector<uint32_t>>& rows, size_t columnCount)
+        : rowCount(rows.size()), columnCount(columnCount),
+          rowWords((columnCount + 63) / 64), columnWords((rows.size() + 63) / 64),
+          rowBits(rowCount * rowWords, 0), columnBits(columnCount * columnWords, 0) {
+        for (size_t r = 0; r < rowCount; r++) {
+            for (uint32_t c : rows[r]) {
+                rowBits[r * rowWords + c / 64] |= uint64_t(1) << (c % 64);
+                columnBits[c * columnWords + r / 64] |= uint64_t(1) << (r % 64);
+            }
+        }
+    }
+
+    const uint64_t* row(size_t r) const { return &rowBits[r * rowWords]; }
+    const uint64_t* column(size_t c) const { return &columnBits[c * columnWords]; }
+
+    size_t rowCount, columnCount, rowWords, columnWords;
+
+private:
+    vector<uint64_t> rowBits, columnBits;
+};
+
+struct SearchState {
+    vector<uint64_t> activeRows;    // rows still to cover
+    vector<uint64_t> activeColumns; // columns still selectable
+    vector<uint32_t> chosen;
+    uint64_t cost;
+};
+
+inline bool testBit(const vector<uint64_t>& bits, size_t i) { return (bits[i / 64] >> (i % 64)) & 1; }
+inline void clearBit(vector<uint64_t>& bits, size_t i) { bits[i / 64] &= ~(uint64_t(1) << (i % 64)); }
+
+template <typename Body>
+void forEachBit(const vector<uint64_t>& bits, Body body) {
+    for (size_t w = 0; w < bits.size(); w++) {
+        for (uint64_t word = bits[w]; word; word &= word - 1) body(w * 64 + __builtin_ctzll(word));
+    }
+}
+
+class CoverSearch {
+public:
+    CoverSearch(const CoverTable& table, const vector<uint64_t>& costs, size_t nodeLimit, SolveBudget* budget)
+        : table(table), costs(costs), nodeLimit(nodeLimit), budget(budget), nodes(0),
+          bestCost(std::numeric_limits<uint64_t>::max()), complete(true) {}
+
+    CoverSolution run() {
+        SearchState root;
+        root.activeRows.assign(table.columnWords, ~uint64_t(0));
+        root.activeColumns.assign(table.rowWords, ~uint64_t(0));
+        trim(root.activeRows, table.rowCount);
+        trim(root.activeColumns, table.columnCount);
+        root.cost = 0;
+
+        if (!reduce(root)) return {best, complete, 0};
+        uint64_t rootBound = root.cost + lowerBound(root);
+        greedy(root);
+        branch(root);
+        return {best, complete, complete ? bestCost : std::min(rootBound, bestCost)};
+    }
+
+private:
+    static void trim(vector<uint64_t>& bits, size_t count) {
+        if (count % 64) bits.back() &= (uint64_t(1) << (count % 64)) - 1;
+        if (count == 0) bits.assign(bits.size(), 0);
+    }
+
+    size_t rowDegree(size_t r, const SearchState& s) const {
+        const uint64_t* row = table.row(r);
+        size_t count = 0;
+        for (size_t w = 0; w < table.rowWords; w++) count += __builtin_popcountll(row[w] & s.activeColumns[w]);
+        return count;
+    }
+
+    size_t columnDegree(size_t c, const SearchState& s) const {
+        const uint64_t* column = table.column(c);
+        size_t count = 0;
+        for (size_t w = 0; w < table.columnWords; w++) count += __builtin_popcountll(column[w] & s.activeRows[w]);
+        return count;
+    }
+
+    void take(SearchState& s, size_t c) const {
+        const uint64_t* column = table.column(c);
+        for (size_t w = 0; w < table.columnWords; w++) s.activeRows[w] &= ~column[w];
+        clearBit(s.activeColumns, c);
+        s.chosen.push_back(static_cast<uint32_t>(c));
+        s.cost += costs[c];
+    }
+
+    // Apply essential columns and dominance until nothing changes; false if some
+    // row can no longer be covered
+    bool reduce(SearchState& s) const {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+
+            // Essential: a row with a single remaining column forces it
+            bool infeasible = false;
+            forEachBit(s.activeRows, [&](size_t r) {
+                if (infeasible || !testBit(s.activeRows, r)) return;
+                size_t degree = rowDegree(r, s);
+                if (degree == 0) {
+                    infeasible = true;
+                } else if (degree == 1) {
+                    const uint64_t* row = table.row(r);
+                    for (size_t w = 0; w < table.rowWords; w++) {
+                        uint64_t live = row[w] & s.activeColumns[w];
+                        if (live) {
+                            take(s, w * 64 + __builtin_ctzll(live));
+                            break;
+                        }
+                    }
+                    changed = true;
+                }
+            });
+            if (infeasible) return false;
+
+            vector<uint32_t> rows, columns;
+            forEachBit(s.activeRows, [&](size_t r) { rows.push_back(r); });
+            forEachBit(s.activeColumns, [&](size_t c) { columns.push_back(c); });
+
+            // Row dominance: a row whose columns include another row's is covered for free
+            if (rows.size() * rows.size() * table.rowWords <= kDominanceBudget) {
+                for (uint32_t r1 : rows) {
+                    for (uint32_t r2 : rows) {
+                        if (r1 == r2 || !testBit(s.activeRows, r2)) continue;
+                        if (subsetOf(table.row(r2), table.row(r1), s.activeColumns, table.rowWords) &&
+                            (r1 > r2 || !subsetOf(table.row(r1), table.row(r2), s.activeColumns, table.rowWords))) {
+                            clearBit(s.activeRows, r1);
+                            changed = true;
+                            break;
+                        }
+                    }
+                }
+            }
+
+            // Column dominance: drop a column whose rows another no-costlier column also covers
+            if (columns.size() * columns.size() * table.columnWords <= kDominanceBudget) {
+                for (uint32_t c2 : columns) {
+                    for (uint32_t c1 : columns) {
+                        if (c1 == c2 || !testBit(s.activeColumns, c1) || costs[c1] > costs[c2]) continue;
+                        if (subsetOf(table.column(c2), table.column(c1), s.activeRows, table.columnWords) &&
+                            (costs[c1] < costs[c2] || c1 < c2 ||
+                             !subsetOf(table.column(c1), table.column(c2), s.activeRows, table.columnWords))) {
+                            clearBit(s.activeColumns, c2);
+                            changed = true;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    static bool subsetOf(const uint64_t* a, const uint64_t* b, const vector<uint64_t>& live, size_t words) {
+        for (size_t w = 0; w < words; w++) {
+            if (a[w] & live[w] & ~b[w]) return false;
+        }
+        return true;
+    }
+
+    uint64_t minColumnCost(size_t r, const SearchState& s) const {
+        uint64_t cheapest = std::numeric_limits<uint64_t>::max();
+        const uint64_t* row = table.row(r);
+        for (size_t w = 0; w < table.rowWords; w++) {
+            for (uint64_t live = row[w] & s.activeColumns[w]; live; live &= live - 1) {
+                cheapest = std::min(cheapest, costs[w * 64 + __builtin_ctzll(live)]);
+            }
+        }
+        return cheapest;
+    }
+
+    // Rows that share no column each need their own column: a maximal independent
+    // set of rows (shortest rows first) bounds the remaining cost from below
+    uint64_t lowerBound(const SearchState& s) const {
+        vector<std::pair<size_t, uint32_t>> rows;
+        forEachBit(s.activeRows, [&](size_t r) { rows.emplace_back(rowDegree(r, s), r); });
+        std::sort(rows.begin(), rows.end());
+        vector<uint64_t> blocked(table.rowWords, 0);
+        uint64_t bound = 0;
+        for (const auto& entry : rows) {
+            const uint64_t* row = table.row(entry.second);
+            bool independent = true;
+            for (size_t w = 0; w < table.rowWords && independent; w++) {
+                if (row[w] & s.activeColumns[w] & blocked[w]) independent = false;
+            }
+            if (!independent) continue;
+            for (size_t w = 0; w < table.rowWords; w++) blocked[w] |= row[w] & s.activeColumns[w];
+            bound += minColumnCost(entry.second, s);
+        }
+        return bound;
+    }
+
+    bool anyRows(const SearchState& s) const {
+        for (uint64_t w : s.activeRows) {
+            if (w) return true;
+        }
+        return false;
+    }
+
+    // Cheapest cost per newly covered row first; gives the initial upper bound.
+    // Once the budget runs out, each row left just takes its cheapest column.
+    void greedy(SearchState s) {
+        while (anyRows(s)) {
+            if (budget && !budget->spend()) {
+                forEachBit(s.activeRows, [&](size_t r) {
+                    if (!testBit(s.activeRows, r)) return;
+                    uint64_t cheapest = minColumnCost(r, s);
+                    const uint64_t* row = table.row(r);
+                    for (size_t w = 0; w < table.rowWords; w++) {
+                        for (uint64_t live = row[w] & s.activeColumns[w]; live; live &= live - 1) {
+                            size_t c = w * 64 + __builtin_ctzll(live);
+                            if (costs[c] == cheapest) return take(s, c);
+                        }
+                    }
+                });
+                if (anyRows(s)) return; // uncoverable row
+                break;
+            }
+            size_t bestColumn = 0;
+            double bestRatio = -1;
+            forEachBit(s.activeColumns, [&](size_t c) {
+                size_t degree = columnDegree(c, s);
+                double ratio = double(degree) / double(costs[c] ? costs[c] : 1);
+                if (degree > 0 && ratio > bestRatio) {
+                    bestRatio = ratio;
+                    bestColumn = c;
+                }
+            });
+            if (bestRatio < 0) return; // uncoverable row
+            take(s, bestColumn);
+        }
+        if (s.cost < bestCost) {
+            bestCost = s.cost;
+            best = s.chosen;
+        }
+    }
+
+    void branch(SearchState& s) {
+        if (!anyRows(s)) {
+            if (s.cost < bestCost) {
+                bestCost = s.cost;
+                best = s.chosen;
+            }
+            return;
+        }
+        if (s.cost + lowerBound(s) >= bestCost) return;
+        if (++nodes > nodeLimit || (budget && !budget->spend())) {
+            complete = false;
+            return;
+        }
+
+        // Branch on the columns of the row with the fewest choices, best coverage first
+        size_t pivot = 0, pivotDegree = std::numeric_limits<size_t>::max();
+        forEachBit(s.activeRows, [&](size_t r) {
+            size_t degree = rowDegree(r, s);
+            if (degree < pivotDegree) {
+                pivotDegree = degree;
+                pivot = r;
+            }
+        });
+        vector<std::pair<size_t, uint32_t>> choices;
+        const uint64_t* row = table.row(pivot);
+        for (size_t w = 0; w < table.rowWords; w++) {
+            for (uint64_t live = row[w] & s.activeColumns[w]; live; live &= live - 1) {
+                size_t c = w * 64 + __builtin_ctzll(live);
+                choices.emplace_back(columnDegree(c, s), c);
+            }
+        }
+        std::sort(choices.begin(), choices.end(), [](const std::pair<size_t, uint32_t>& a,
+                                                     const std::pair<size_t, uint32_t>& b) {
+            return a.first != b.first ? a.first > b.first : a.second < b.second;
+        });
+
+        // Once a column's subtree is explored, later siblings may exclude it
+        SearchState rest = s;
+        for (const auto& choice : choices) {
+            SearchState child = rest;
+            take(child, choice.second);
+            if (reduce(child)) branch(child);
+            clearBit(rest.activeColumns, choice.second);
+            if (!complete) return;
+        }
+    }
+
+    const CoverTable& table;
+    const vector<uint64_t>& costs;
+    size_t nodeLimit;
+    SolveBudget* budget;
+    size_t nodes;
+    vector<uint32_t> best;
+    uint64_t bestCost;
+    bool complete;
+};
+
+// Greedy cover straight from the row lists, for tables too large for the bit
+// matrix: same choice rule as CoverSearch::greedy(), with lazily refreshed
+// column degrees (they only fall) instead of a rescan per pick
+CoverSolution sparseGreedyCover(const vector<vector<uint32_t>>& rows, const vector<uint64_t>& costs,
+                                SolveBudget* budget) {
+    vector<vector<uint32_t>> columnRows(costs.size());
+    for (size_t r = 0; r < rows.size(); r++) {
+        if (rows[r].empty()) return {{}, false, 0}; // uncoverable row
+        for (uint32_t c : rows[r]) columnRows[c].push_back(static_cast<uint32_t>(r));
+    }
+    auto cheapestColumn = [&](size_t r) {
+        uint32_t cheapest = rows[r][0];
+        for (uint32_t c : rows[r]) {
+            if (costs[c] < costs[cheapest]) cheapest = c;
+        }
+        return cheapest;
+    };
+
+    // Rows that share no column each need their own column (shortest rows first)
+    vector<std::pair<size_t, uint32_t>> order;
+    for (size_t r = 0; r < rows.size(); r++) order.emplace_back(rows[r].size(), static_cast<uint32_t>(r));
+    std::sort(order.begin(), order.end());
+    vector<char> blocked(costs.size(), 0);
+    uint64_t bound = 0;
+    for (const auto& entry : order) {
+        const vector<uint32_t>& row = rows[entry.second];
+        if (std::any_of(row.begin(), row.end(), [&](uint32_t c) { return blocked[c]; })) continue;
+        for (uint32_t c : row) blocked[c] = 1;
+        bound += costs[cheapestColumn(entry.second)];
+    }
+
+    vector<char> covered(rows.size(), 0);
+    vector<uint32_t> columns;
+    auto take = [&](uint32_t c) {
+        columns.push_back(c);
+        for (uint32_t r : columnRows[c]) covered[r] = 1;
+    };
+    auto ratio = [&](uint32_t c) {
+        size_t degree = 0;
+        for (uint32_t r : columnRows[c]) degree += !covered[r];
+        return double(degree) / double(costs[c] ? costs[c] : 1);
+    };
+    std::priority_queue<std::pair<double, uint32_t>> queue;
+    for (size_t c = 0; c < costs.size(); c++) {
+        if (!columnRows[c].empty()) queue.emplace(ratio(static_cast<uint32_t>(c)), static_cast<uint32_t>(c));
+    }
+    size_t left = rows.size();
+    while (left > 0 && !queue.empty() && (!budget || budget->spend())) {
+        std::pair<double, uint32_t> top = queue.top();
+        queue.pop();
+        double current = ratio(top.second);
+        if (current <= 0) continue;
+        if (!queue.empty() && current < queue.top().first) {
+            queue.emplace(current, top.second);
+            continue;
+        }
+        for (uint32_t r : columnRows[top.second]) left -= !covered[r];
+        take(top.second);
+    }
+    // Out of budget: each row left just takes its cheapest column
+    for (size_t r = 0; r < rows.size(); r++) {
+        if (!covered[r]) take(cheapestColumn(r));
+    }
+    return {columns, false, bound};
+}
+
+} // namespace
+
+CoverSolution solveUnateCover(const vector<vector<uint32_t>>& rows, const vector<uint64_t>& columnCosts,
+                              size_t nodeLimit, SolveBudget* budget) {
+    // Check the size before allocating the bit matrix
+    if (rows.size() * columnCosts.size() > kMatrixBitLimit) return sparseGreedyCover(rows, columnCosts, budget);
+    CoverTable table(rows, columnCosts.size());
+    CoverSearch search(table, columnCosts, nodeLimit, budget);
+    return search.run();
+}
@@ -0,0 +1,64 @@
+#ifndef COVER_SOLVER_HPP
+#define COVER_SOLVER_HPP
+
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+
+using std::vector;
+
+// Branch-and-bound nodes explored before settling for the best cover found so far
+const size_t kDefaultCoverNodeLimit = 200000;
+
+// Wall-clock and step limits for one solve, shared by every stage and thread
+// working on it. A step is one unit of search: a covering node or greedy pick,
+// a prime generation column or implicit prime node, an essential peeling round,
+// an Espresso expansion, a sifting trial, a block of BDD/ZDD nodes or a block of
+// covering rows. Once spend() fails, each stage stops and keeps the best valid
+// result it has.
+class SolveBudget {
+public:
+    SolveBudget() = default; // unlimited
+    // Limits counted from now; 0 means none
+    SolveBudget(uint64_t deadlineMs, uint64_t stepLimit);
+
+    // Count `steps` more; false once either limit is reached, and from then on.
+    // spend(0) only checks the clock.
+    bool spend(uint64_t steps = 1);
+    bool expired() const { return out.load(std::memory_order_relaxed); }
+
+private:
+    std::chrono::steady_clock::time_point deadline;
+    bool hasDeadline = false;
+    uint64_t stepLimit = 0;
+    std::atomic<uint64_t> used{0};
+    std::atomic<bool> out{false};
+};
+
+// Thrown by stages that cannot stop with a valid partial result (BDD and ZDD
+// operations) once their budget runs out; the caller falls back to a cheaper cover
+class SolveBudgetExpired : public std::runtime_error {
+public:
+    SolveBudgetExpired() : std::runtime_error("Solve budget expired") {}
+};
+
+struct CoverSolution {
+    vector<uint32_t> columns; // chosen columns
+    bool provenOptimal;       // false if the search stopped at its node limit or budget
+    uint64_t lowerBound;      // no cover costs less; the cost of `columns` once proven
+};
+
+// Exact unate covering: pick a minimum-cost set of columns so that every row has
+// a chosen column. rows[r] lists the columns covering row r. The table is held as
+// a bit matrix and reduced with essential columns, row dominance and column
+// dominance before branch-and-bound, which is pruned with an independent-set
+// lower bound and seeded with a greedy cover, which is what is left when the
+// search is cut off. Tables too large for the bit matrix are only covered
+// greedily, straight from the row lists.
+CoverSolution solveUnateCover(const vector<vector<uint32_t>>& rows, const vector<uint64_t>& columnCosts,
+                              size_t nodeLimit = kDefaultCoverNodeLimit, SolveBudget* budget = nullptr);
+
+#endif // COVER_SOLVER_HPP
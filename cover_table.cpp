@@ -0,0 +1,15 @@
+#include "cover_table.hpp"
+
+// Generated by cover_table_gen into the build directory
+static const uint64_t kCoverTable[kCoverTableSize] = {
+#include "cover_table.inc"
+};
+
+void lookupMinimalCover(uint16_t function, int varCount, CubeList& cover) {
+    uint64_t entry = kCoverTable[kCoverTableBase[varCount] + function];
+    for (int i = 0; i < kMaxCoverTableCubes; i++, entry >>= 8) {
+        uint8_t byte = entry & 0xFF;
+        if (byte == kNoCube) break;
+        cover.push_back(decodeTableCube(byte));
+    }
+}
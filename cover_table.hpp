@@ -0,0 +1,35 @@
+#ifndef COVER_TABLE_HPP
+#define COVER_TABLE_HPP
+
+#include "truth_table.hpp"
+#include "cube_arena.hpp"
+
+// Largest variable count answered from the precomputed cover table
+const int kMaxCoverTableVariables = 4;
+
+// First entry of each variable count: the table holds the 16 two-variable
+// functions, then the 256 three-variable ones, then the 65,536 four-variable ones
+const size_t kCoverTableBase[kMaxCoverTableVariables + 1] = {0, 0, 0, 16, 16 + 256};
+const size_t kCoverTableSize = 16 + 256 + 65536;
+
+// An entry is one word holding up to 8 cubes (the most any 4-variable minimal
+// cover needs), one per byte: care mask in the high nibble, value in the low.
+// Unused bytes hold kNoCube, whose value lies outside its mask.
+const uint8_t kNoCube = 0x0F;
+const int kMaxCoverTableCubes = 8;
+
+inline uint8_t encodeTableCube(const Cube& cube) {
+    return static_cast<uint8_t>((cube.mask << 4) | cube.value);
+}
+
+inline Cube decodeTableCube(uint8_t byte) {
+    return {uint64_t(byte >> 4), uint64_t(byte & 0x0F)};
+}
+
+// Append the minimal cover (fewest cubes, then fewest literals) of the
+// `varCount`-variable function whose truth table is the low 2^varCount bits of
+// `function`, for 2 <= varCount <= 4. The cover is a single load from a table
+// that cover_table_gen builds and checks at build time.
+void lookupMinimalCover(uint16_t function, int varCount, CubeList& cover);
+
+#endif // COVER_TABLE_HPP
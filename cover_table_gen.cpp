@@ -0,0 +1,133 @@
+// Build step: writes the minimal cover of every 2-, 3- and 4-variable function
+// as the initializer of cover_table.cpp, after checking every entry against an
+// exhaustive search.
+#include "cover_table.hpp"
+#include "kmap_kernels.hpp"
+#include "quine_mccluskey.hpp"
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+using std::string;
+
+namespace {
+
+// Cubes of an n-variable function as 16-bit cell sets
+struct SmallCube {
+    uint16_t cells;
+    int literals;
+};
+
+uint16_t cubeCells(const Cube& cube, int varCount) {
+    uint16_t cells = 0;
+    for (uint64_t m = 0; m < (uint64_t(1) << varCount); m++) {
+        if (cubeContainsMinterm(cube, m)) cells |= uint16_t(1) << m;
+    }
+    return cells;
+}
+
+// Minimum (cubes, then literals) cover of `function` by brute force: every
+// subcube inside the function, reduced to the maximal ones, then a depth-first
+// search over the primes containing the first uncovered minterm. It shares no
+// code with the prime kernels and covering solver it checks.
+class ExhaustiveMinimum {
+public:
+    ExhaustiveMinimum(uint16_t function, int varCount) {
+        vector<SmallCube> implicants;
+        for (uint64_t mask = 0; mask < (uint64_t(1) << varCount); mask++) {
+            for (uint64_t value = mask;; value = (value - 1) & mask) {
+                uint16_t cells = cubeCells({mask, value}, varCount);
+                if ((cells & ~function) == 0) implicants.push_back({cells, __builtin_popcountll(mask)});
+                if (value == 0) break;
+            }
+        }
+        for (const SmallCube& c : implicants) {
+            bool maximal = true;
+            for (const SmallCube& d : implicants) {
+                if (d.cells != c.cells && (c.cells & ~d.cells) == 0) maximal = false;
+            }
+            if (maximal) primes.push_back(c);
+        }
+        search(function, 0, 0);
+    }
+
+    int cubes = kMaxCoverTableCubes + 1;
+    int literals = 0;
+
+private:
+    void search(uint16_t uncovered, int count, int lits) {
+        if (count > cubes || (count == cubes && lits >= literals)) return;
+        if (uncovered == 0) {
+            cubes = count;
+            literals = lits;
+            return;
+        }
+        uint16_t first = uncovered & -uncovered;
+        for (const SmallCube& p : primes) {
+            if (p.cells & first) search(uncovered & ~p.cells, count + 1, lits + p.literals);
+        }
+    }
+
+    vector<SmallCube> primes;
+};
+
+uint64_t coverEntry(uint16_t function, int varCount) {
+    TruthTable table(varCount);
+    table.words()[0] = function;
+    CubeArena arena;
+    CubeList primes(arena);
+    findKMapPrimes(table, primes);
+    bool provenOptimal = false;
+    vector<Cube> cover = selectCover(primes.data(), primes.size(), table, &provenOptimal);
+
+    string where = std::to_string(varCount) + "-variable function " + std::to_string(function);
+    uint16_t covered = 0;
+    int literals = 0;
+    for (const Cube& cube : cover) {
+        covered |= cubeCells(cube, varCount);
+        literals += __builtin_popcountll(cube.mask);
+    }
+    if (covered != function) throw std::runtime_error("cover of " + where + " is not equivalent");
+    ExhaustiveMinimum minimum(function, varCount);
+    if (!provenOptimal || static_cast<int>(cover.size()) != minimum.cubes || literals != minimum.literals) {
+        throw std::runtime_error("cover of " + where + " is not minimal");
+    }
+
+    uint64_t entry = 0;
+    for (int i = kMaxCoverTableCubes - 1; i >= 0; i--) {
+        uint8_t byte = i < static_cast<int>(cover.size()) ? encodeTableCube(cover[i]) : kNoCube;
+        entry = (entry << 8) | byte;
+    }
+    return entry;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <output.inc>\n", argv[0]);
+        return 1;
+    }
+    try {
+        vector<uint64_t> entries;
+        entries.reserve(kCoverTableSize);
+        for (int varCount = 2; varCount <= kMaxCoverTableVariables; varCount++) {
+            for (uint32_t function = 0; function < (uint32_t(1) << (1 << varCount)); function++) {
+                entries.push_back(coverEntry(static_cast<uint16_t>(function), varCount));
+            }
+        }
+
+        FILE* out = fopen(argv[1], "w");
+        if (!out) throw std::runtime_error(string("cannot write ") + argv[1]);
+        fprintf(out, "// Generated by cover_table_gen; do not edit\n");
+        for (size_t i = 0; i < entries.size(); i++) {
+            fprintf(out, "0x%016llxull,%c", static_cast<unsigned long long>(entries[i]), i % 4 == 3 ? '\n' : ' ');
+        }
+        fprintf(out, "\n");
+        fclose(out);
+    } catch (const std::exception& e) {
+        fprintf(stderr, "cover_table_gen: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
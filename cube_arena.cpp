@@ -0,0 +1,41 @@
+#include "cube_arena.hpp"
+#include <algorithm>
+
+CubeArena::CubeArena(size_t blockCubes) : current(0), offset(0), blockCubes(blockCubes) {}
+
+Cube* CubeArena::allocate(size_t count) {
+    if (current < blocks.size() && offset + count <= blockSizes[current]) {
+        Cube* cubes = blocks[current].get() + offset;
+        offset += count;
+        return cubes;
+    }
+
+    // Move on to the next block, making room for an oversized request if the
+    // kept block is too small; blocks at or before a live mark never move
+    size_t next = blocks.empty() ? 0 : current + 1;
+    if (next >= blocks.size() || blockSizes[next] < count) {
+        size_t size = std::max(count, blockCubes);
+        blocks.emplace(blocks.begin() + next, new Cube[size]);
+        blockSizes.insert(blockSizes.begin() + next, size);
+    }
+    current = next;
+    offset = count;
+    return blocks[current].get();
+}
+
+void CubeArena::rewind(const Mark& mark) {
+    current = mark.block;
+    offset = mark.offset;
+}
+
+CubeArena& threadCubeArena() {
+    thread_local CubeArena arena;
+    return arena;
+}
+
+void CubeList::grow() {
+    capacity = capacity ? capacity * 2 : 16;
+    Cube* grown = owner.allocate(capacity);
+    std::copy(items, items + count, grown);
+    items = grown;
+}
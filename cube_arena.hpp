@@ -0,0 +1,97 @@
+#ifndef CUBE_ARENA_HPP
+#define CUBE_ARENA_HPP
+
+#include "truth_table.hpp"
+#include <memory>
+#include <type_traits>
+
+// Bump allocator for cubes. Memory comes in blocks that are kept when the arena
+// is rewound, so once a workload has warmed the arena up, later solves reuse the
+// same blocks for their cubes. Rewinding to a mark and reset() are O(1).
+//
+// Functions of up to kMaxWordVariables variables are minimized entirely in the
+// arena: kmapWordCover() keeps the primes, the essentials, the cover and the
+// covering search's scratch here, so a warm batch of them makes no heap
+// allocations (see arena_bench). Larger functions only keep their K-map
+// rectangles and cover lists here; Quine-McCluskey, Espresso, the implicit
+// engines and solveUnateCover() use heap vectors, as does the SolveResult
+// snapshot every KMapSolver solve publishes.
+class CubeArena {
+public:
+    struct Mark {
+        size_t block, offset;
+    };
+
+    explicit CubeArena(size_t blockCubes = 4096);
+
+    Cube* allocate(size_t count);
+    // Scratch array of plain words or indices, carved from the same blocks
+    template <typename T>
+    T* allocateArray(size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value && alignof(T) <= alignof(Cube),
+                      "arena arrays hold plain values");
+        return reinterpret_cast<T*>(allocate((count * sizeof(T) + sizeof(Cube) - 1) / sizeof(Cube)));
+    }
+    Mark mark() const { return {current, offset}; }
+    void rewind(const Mark& mark);
+    void reset() { rewind({0, 0}); }
+
+    // Blocks held, i.e. the arena's high-water mark
+    size_t blockCount() const { return blocks.size(); }
+
+private:
+    vector<std::unique_ptr<Cube[]>> blocks;
+    vector<size_t> blockSizes;
+    size_t current, offset;
+    size_t blockCubes;
+};
+
+// Arena of the calling thread, shared by every solve that runs on it
+CubeArena& threadCubeArena();
+
+// Rewinds the thread's arena to where it was when the scope began
+class CubeArenaScope {
+public:
+    CubeArenaScope() : arena(threadCubeArena()), start(arena.mark()) {}
+    ~CubeArenaScope() { arena.rewind(start); }
+    CubeArenaScope(const CubeArenaScope&) = delete;
+    CubeArenaScope& operator=(const CubeArenaScope&) = delete;
+
+    CubeArena& arena;
+
+private:
+    CubeArena::Mark start;
+};
+
+// Growable cube list in an arena. Growing moves the list to a span twice the
+// size; the old span is reclaimed when the arena is rewound.
+class CubeList {
+public:
+    explicit CubeList(CubeArena& arena) : owner(arena), items(nullptr), count(0), capacity(0) {}
+
+    void push_back(const Cube& cube) {
+        if (count == capacity) grow();
+        items[count++] = cube;
+    }
+    void pop_back() { count--; }
+    void clear() { count = 0; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    Cube* data() { return items; }
+    const Cube* data() const { return items; }
+    Cube* begin() { return items; }
+    Cube* end() { return items + count; }
+    const Cube* begin() const { return items; }
+    const Cube* end() const { return items + count; }
+    const Cube& operator[](size_t i) const { return items[i]; }
+    CubeArena& arena() const { return owner; }
+
+private:
+    void grow();
+
+    CubeArena& owner;
+    Cube* items;
+    size_t count, capacity;
+};
+
+#endif // CUBE_ARENA_HPP
@@ -0,0 +1,158 @@
+#include "cube_kernels.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CUBE_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+CubeArray::CubeArray(const vector<Cube>& cubes) {
+    maskWords.reserve(cubes.size());
+    valueWords.reserve(cubes.size());
+    for (const Cube& c : cubes) push_back(c);
+}
+
+template <CubeRelation relation>
+static inline bool matches(uint64_t mask, uint64_t value, const Cube& query) {
+    uint64_t diff = value ^ query.value;
+    switch (relation) {
+        case CubeRelation::Contains:
+            return (mask & ~query.mask) == 0 && (diff & mask) == 0;
+        case CubeRelation::ContainedBy:
+            return (query.mask & ~mask) == 0 && (diff & query.mask) == 0;
+        default:
+            return mask == query.mask && diff != 0 && (diff & (diff - 1)) == 0;
+    }
+}
+
+// Scans candidates [begin, count); returns true as soon as one matches when
+// `firstOnly` is set, otherwise appends every match
+template <CubeRelation relation, bool firstOnly>
+static bool findScalar(const CubeArray& cubes, const Cube& query, size_t begin, vector<uint32_t>* out) {
+    const uint64_t* masks = cubes.masks();
+    const uint64_t* values = cubes.values();
+    for (size_t i = begin; i < cubes.size(); i++) {
+        if (!matches<relation>(masks[i], values[i], query)) continue;
+        if (firstOnly) return true;
+        out->push_back(static_cast<uint32_t>(i));
+    }
+    return false;
+}
+
+#ifdef CUBE_KERNELS_X86
+// Lanes of the match vector are all ones where the candidate matches
+template <CubeRelation relation>
+__attribute__((target("avx2")))
+static inline __m256i matchAVX2(__m256i mask, __m256i value, __m256i queryMask, __m256i queryValue) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i diff = _mm256_xor_si256(value, queryValue);
+    switch (relation) {
+        case CubeRelation::Contains:
+            return _mm256_cmpeq_epi64(_mm256_or_si256(_mm256_andnot_si256(queryMask, mask),
+                                                      _mm256_and_si256(diff, mask)), zero);
+        case CubeRelation::ContainedBy:
+            return _mm256_cmpeq_epi64(_mm256_or_si256(_mm256_andnot_si256(mask, queryMask),
+                                                      _mm256_and_si256(diff, queryMask)), zero);
+        default: {
+            // diff is a single bit: nonzero and diff & (diff - 1) == 0
+            __m256i single = _mm256_cmpeq_epi64(
+                _mm256_and_si256(diff, _mm256_sub_epi64(diff, _mm256_set1_epi64x(1))), zero);
+            __m256i nonzero = _mm256_andnot_si256(_mm256_cmpeq_epi64(diff, zero), single);
+            return _mm256_and_si256(_mm256_cmpeq_epi64(mask, queryMask), nonzero);
+        }
+    }
+}
+
+template <CubeRelation relation, bool firstOnly>
+__attribute__((target("avx2")))
+static bool findAVX2(const CubeArray& cubes, const Cube& query, vector<uint32_t>* out) {
+    const __m256i queryMask = _mm256_set1_epi64x(static_cast<long long>(query.mask));
+    const __m256i queryValue = _mm256_set1_epi64x(static_cast<long long>(query.value));
+    const uint64_t* masks = cubes.masks();
+    const uint64_t* values = cubes.values();
+    size_t i = 0;
+    for (; i + 4 <= cubes.size(); i += 4) {
+        __m256i mask = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(masks + i));
+        __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        int hits = _mm256_movemask_pd(_mm256_castsi256_pd(matchAVX2<relation>(mask, value, queryMask, queryValue)));
+        if (!hits) continue;
+        if (firstOnly) return true;
+        for (; hits; hits &= hits - 1) out->push_back(static_cast<uint32_t>(i + __builtin_ctz(hits)));
+    }
+    return findScalar<relation, firstOnly>(cubes, query, i, out);
+}
+
+template <CubeRelation relation>
+__attribute__((target("sse4.2")))
+static inline __m128i matchSSE42(__m128i mask, __m128i value, __m128i queryMask, __m128i queryValue) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i diff = _mm_xor_si128(value, queryValue);
+    switch (relation) {
+        case CubeRelation::Contains:
+            return _mm_cmpeq_epi64(_mm_or_si128(_mm_andnot_si128(queryMask, mask), _mm_and_si128(diff, mask)), zero);
+        case CubeRelation::ContainedBy:
+            return _mm_cmpeq_epi64(_mm_or_si128(_mm_andnot_si128(mask, queryMask), _mm_and_si128(diff, queryMask)),
+                                   zero);
+        default: {
+            __m128i single = _mm_cmpeq_epi64(_mm_and_si128(diff, _mm_sub_epi64(diff, _mm_set1_epi64x(1))), zero);
+            __m128i nonzero = _mm_andnot_si128(_mm_cmpeq_epi64(diff, zero), single);
+            return _mm_and_si128(_mm_cmpeq_epi64(mask, queryMask), nonzero);
+        }
+    }
+}
+
+template <CubeRelation relation, bool firstOnly>
+__attribute__((target("sse4.2")))
+static bool findSSE42(const CubeArray& cubes, const Cube& query, vector<uint32_t>* out) {
+    const __m128i queryMask = _mm_set1_epi64x(static_cast<long long>(query.mask));
+    const __m128i queryValue = _mm_set1_epi64x(static_cast<long long>(query.value));
+    const uint64_t* masks = cubes.masks();
+    const uint64_t* values = cubes.values();
+    size_t i = 0;
+    for (; i + 2 <= cubes.size(); i += 2) {
+        __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks + i));
+        __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        int hits = _mm_movemask_pd(_mm_castsi128_pd(matchSSE42<relation>(mask, value, queryMask, queryValue)));
+        if (!hits) continue;
+        if (firstOnly) return true;
+        for (; hits; hits &= hits - 1) out->push_back(static_cast<uint32_t>(i + __builtin_ctz(hits)));
+    }
+    return findScalar<relation, firstOnly>(cubes, query, i, out);
+}
+#endif
+
+template <CubeRelation relation, bool firstOnly>
+static bool find(const CubeArray& cubes, const Cube& query, vector<uint32_t>* out, SimdLevel level) {
+#ifdef CUBE_KERNELS_X86
+    if (level == SimdLevel::AVX2) return findAVX2<relation, firstOnly>(cubes, query, out);
+    if (level == SimdLevel::SSE42) return findSSE42<relation, firstOnly>(cubes, query, out);
+#endif
+    (void)level;
+    return findScalar<relation, firstOnly>(cubes, query, 0, out);
+}
+
+void findCubes(const CubeArray& cubes, const Cube& query, CubeRelation relation, vector<uint32_t>& out) {
+    findCubes(cubes, query, relation, out, detectSimdLevel());
+}
+
+void findCubes(const CubeArray& cubes, const Cube& query, CubeRelation relation, vector<uint32_t>& out,
+               SimdLevel level) {
+    switch (relation) {
+        case CubeRelation::Contains:
+            find<CubeRelation::Contains, false>(cubes, query, &out, level);
+            break;
+        case CubeRelation::ContainedBy:
+            find<CubeRelation::ContainedBy, false>(cubes, query, &out, level);
+            break;
+        case CubeRelation::MergesWith:
+            find<CubeRelation::MergesWith, false>(cubes, query, &out, level);
+            break;
+    }
+}
+
+bool anyCubeContains(const CubeArray& cubes, const Cube& query) {
+    return anyCubeContains(cubes, query, detectSimdLevel());
+}
+
+bool anyCubeContains(const CubeArray& cubes, const Cube& query, SimdLevel level) {
+    return find<CubeRelation::Contains, true>(cubes, query, nullptr, level);
+}
@@ -0,0 +1,44 @@
+#ifndef CUBE_KERNELS_HPP
+#define CUBE_KERNELS_HPP
+
+#include "truth_table.hpp"
+
+// Cubes in structure-of-arrays form, so a vector load picks up the care masks
+// (or values) of several cubes at once
+class CubeArray {
+public:
+    CubeArray() {}
+    explicit CubeArray(const vector<Cube>& cubes);
+
+    void push_back(const Cube& cube) {
+        maskWords.push_back(cube.mask);
+        valueWords.push_back(cube.value);
+    }
+    size_t size() const { return maskWords.size(); }
+    Cube operator[](size_t i) const { return {maskWords[i], valueWords[i]}; }
+    const uint64_t* masks() const { return maskWords.data(); }
+    const uint64_t* values() const { return valueWords.data(); }
+
+private:
+    vector<uint64_t> maskWords, valueWords;
+};
+
+// How a candidate cube relates to the query cube
+enum class CubeRelation {
+    Contains,    // the candidate contains the query
+    ContainedBy, // the query contains the candidate
+    MergesWith   // same care mask, values differ in exactly one bit
+};
+
+// Append to `out` the indices of the cubes in `cubes` that stand in `relation` to
+// `query`, in increasing order. AVX2 tests four candidates per step and SSE4.2
+// two; the overload without a level uses detectSimdLevel().
+void findCubes(const CubeArray& cubes, const Cube& query, CubeRelation relation, vector<uint32_t>& out);
+void findCubes(const CubeArray& cubes, const Cube& query, CubeRelation relation, vector<uint32_t>& out,
+               SimdLevel level);
+
+// Whether any cube of `cubes` contains `query`, stopping at the first hit
+bool anyCubeContains(const CubeArray& cubes, const Cube& query);
+bool anyCubeContains(const CubeArray& cubes, const Cube& query, SimdLevel level);
+
+#endif // CUBE_KERNELS_HPP
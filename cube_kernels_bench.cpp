@@ -0,0 +1,126 @@
+// Microbenchmark of the cube relation kernels: times the Scalar, SSE4.2 and AVX2
+// paths of findCubes() for each relation and of anyCubeContains() on cube
+// lists shaped like the ones the engines scan, and prints the speedup of each
+// vector path over the scalar one. Paths the CPU lacks are skipped.
+//
+// Usage: cube_kernels_bench [milliseconds per measurement, default 200]
+#include "cube_kernels.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+using std::string;
+
+namespace {
+
+// Cubes over 16 variables with 4 to 12 literals, like the primes of a
+// Quine-McCluskey or implicit core
+vector<Cube> randomCubes(size_t count, std::mt19937_64& random) {
+    const int varCount = 16;
+    vector<Cube> cubes;
+    while (cubes.size() < count) {
+        uint64_t mask = 0;
+        int literals = 4 + random() % 9;
+        while (__builtin_popcountll(mask) < literals) mask |= uint64_t(1) << (random() % varCount);
+        cubes.push_back({mask, random() & mask});
+    }
+    return cubes;
+}
+
+// Queries of each relation: minterms for Contains (the covering rows), cubes of
+// the list itself widened or narrowed by a literal for the other two
+vector<Cube> queriesFor(CubeRelation relation, const vector<Cube>& cubes, std::mt19937_64& random) {
+    vector<Cube> queries;
+    for (size_t q = 0; q < 64; q++) {
+        const Cube& cube = cubes[random() % cubes.size()];
+        uint64_t bit = uint64_t(1) << (random() % 16);
+        switch (relation) {
+            case CubeRelation::Contains:
+                queries.push_back({0xFFFF, random() & 0xFFFF});
+                break;
+            case CubeRelation::ContainedBy:
+                queries.push_back({cube.mask & ~bit, cube.value & ~bit});
+                break;
+            case CubeRelation::MergesWith:
+                queries.push_back({cube.mask, cube.value ^ (bit & cube.mask)});
+                break;
+        }
+    }
+    return queries;
+}
+
+// Nanoseconds per scan of the whole list, over at least `budgetMs`
+template <typename Scan>
+double timeScans(const vector<Cube>& queries, int budgetMs, Scan&& scan) {
+    using Clock = std::chrono::steady_clock;
+    size_t scans = 0, sink = 0;
+    Clock::time_point start = Clock::now(), end;
+    do {
+        for (const Cube& query : queries) sink += scan(query);
+        scans += queries.size();
+        end = Clock::now();
+    } while (end - start < std::chrono::milliseconds(budgetMs));
+    // Keep the results observable so the scans are not optimized away
+    if (sink == size_t(-1)) std::puts("");
+    return std::chrono::duration<double, std::nano>(end - start).count() / scans;
+}
+
+const char* levelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX2: return "AVX2";
+        case SimdLevel::SSE42: return "SSE4.2";
+        default: return "Scalar";
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int budgetMs = argc > 1 ? std::atoi(argv[1]) : 200;
+    if (budgetMs <= 0) {
+        std::fprintf(stderr, "Usage: %s [milliseconds per measurement]\n", argv[0]);
+        return 1;
+    }
+    SimdLevel best = detectSimdLevel();
+    vector<SimdLevel> levels = {SimdLevel::Scalar};
+    if (best == SimdLevel::SSE42 || best == SimdLevel::AVX2) levels.push_back(SimdLevel::SSE42);
+    if (best == SimdLevel::AVX2) levels.push_back(SimdLevel::AVX2);
+
+    struct Kernel {
+        string name;
+        CubeRelation relation;
+        bool firstOnly;
+    };
+    const Kernel kernels[] = {
+        {"findCubes Contains", CubeRelation::Contains, false},
+        {"findCubes ContainedBy", CubeRelation::ContainedBy, false},
+        {"findCubes MergesWith", CubeRelation::MergesWith, false},
+        {"anyCubeContains", CubeRelation::Contains, true},
+    };
+
+    std::printf("%-24s %7s %8s %12s %8s\n", "kernel", "cubes", "path", "ns/scan", "speedup");
+    std::mt19937_64 random(12345);
+    for (size_t count : {64, 1024, 16384}) {
+        vector<Cube> cubes = randomCubes(count, random);
+        CubeArray array(cubes);
+        for (const Kernel& kernel : kernels) {
+            vector<Cube> queries = queriesFor(kernel.relation, cubes, random);
+            double scalar = 0;
+            for (SimdLevel level : levels) {
+                vector<uint32_t> out;
+                double ns = timeScans(queries, budgetMs, [&](const Cube& query) -> size_t {
+                    if (kernel.firstOnly) return anyCubeContains(array, query, level);
+                    out.clear();
+                    findCubes(array, query, kernel.relation, out, level);
+                    return out.size();
+                });
+                if (level == SimdLevel::Scalar) scalar = ns;
+                std::printf("%-24s %7zu %8s %12.1f %7.2fx\n", kernel.name.c_str(), count, levelName(level), ns,
+                            scalar / ns);
+            }
+        }
+    }
+    return 0;
+}
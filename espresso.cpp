@@ -0,0 +1,227 @@
+#include "espresso.hpp"
+#include "cover_solver.hpp"
+#include "cube_kernels.hpp"
+#include <algorithm>
+#include <utility>
+
+static bool cubesConflict(const Cube& a, const Cube& b) {
+    return ((a.value ^ b.value) & a.mask & b.mask) != 0;
+}
+
+static int literalCount(const Cube& cube) {
+    return __builtin_popcountll(cube.mask);
+}
+
+// Cofactor of a cover with respect to a cube: drop conflicting cubes and free
+// the variables the cube fixes
+static vector<Cube> cofactor(const vector<Cube>& cover, const Cube& c) {
+    vector<Cube> result;
+    result.reserve(cover.size());
+    for (const Cube& f : cover) {
+        if (!cubesConflict(f, c)) result.push_back({f.mask & ~c.mask, f.value & ~c.mask});
+    }
+    return result;
+}
+
+// Variable bit that appears in the most cubes of the cover
+static uint64_t mostFrequentVariable(const vector<Cube>& cover) {
+    int counts[64] = {0};
+    for (const Cube& c : cover) {
+        for (uint64_t bits = c.mask; bits; bits &= bits - 1) counts[__builtin_ctzll(bits)]++;
+    }
+    int best = 0;
+    for (int b = 1; b < 64; b++) {
+        if (counts[b] > counts[best]) best = b;
+    }
+    return uint64_t(1) << best;
+}
+
+static bool tautology(vector<Cube> cover) {
+    // Unate reduction: a variable seen in only one polarity can be set against
+    // it, which removes every cube mentioning it without changing the answer
+    while (true) {
+        if (cover.empty()) return false;
+        uint64_t pos = 0, neg = 0;
+        for (const Cube& c : cover) {
+            if (c.mask == 0) return true;
+            pos |= c.value;
+            neg |= c.mask & ~c.value;
+        }
+        uint64_t unate = pos ^ neg;
+        if (unate == 0) break;
+        cover.erase(std::remove_if(cover.begin(), cover.end(),
+                                   [unate](const Cube& c) { return (c.mask & unate) != 0; }),
+                    cover.end());
+    }
+
+    // Every remaining variable is binate: split on the busiest one
+    uint64_t bit = mostFrequentVariable(cover);
+    return tautology(cofactor(cover, {bit, 0})) && tautology(cofactor(cover, {bit, bit}));
+}
+
+bool isTautology(const vector<Cube>& cover) {
+    return tautology(cover);
+}
+
+bool coverContainsCube(const vector<Cube>& cover, const Cube& cube) {
+    return tautology(cofactor(cover, cube));
+}
+
+// Smallest cube containing the complement of the cover; false if the
+// complement is empty. The complement reaches x = 0 exactly when the x = 0
+// cofactor is not a tautology, so each variable costs two tautology checks.
+static bool complementSupercube(const vector<Cube>& cover, Cube& out) {
+    if (tautology(cover)) return false;
+    uint64_t used = 0;
+    for (const Cube& c : cover) used |= c.mask;
+    
+    out = {0, 0};
+    for (uint64_t bits = used; bits; bits &= bits - 1) {
+        uint64_t bit = bits & (~bits + 1);
+        if (tautology(cofactor(cover, {bit, 0}))) {
+            out.mask |= bit;
+            out.value |= bit;
+        } else if (tautology(cofactor(cover, {bit, bit}))) {
+            out.mask |= bit;
+        }
+    }
+    return true;
+}
+
+static vector<Cube> withoutIndex(const vector<Cube>& cover, size_t skip, const vector<Cube>& dcSet) {
+    vector<Cube> result;
+    result.reserve(cover.size() + dcSet.size());
+    for (size_t i = 0; i < cover.size(); i++) {
+        if (i != skip) result.push_back(cover[i]);
+    }
+    result.insert(result.end(), dcSet.begin(), dcSet.end());
+    return result;
+}
+
+// Indices of the cover, largest cubes (fewest literals) first
+static vector<size_t> largestFirst(const vector<Cube>& cover) {
+    vector<size_t> order(cover.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return literalCount(cover[a]) < literalCount(cover[b]);
+    });
+    return order;
+}
+
+// EXPAND: grow every cube into a prime, raising first the literals that bring
+// the most other cubes into reach, and drop the cubes the primes swallow. Cubes
+// reached after the budget runs out are kept unexpanded.
+static vector<Cube> expand(const vector<Cube>& cover, const vector<Cube>& dcSet, SolveBudget* budget) {
+    vector<Cube> function(cover);
+    function.insert(function.end(), dcSet.begin(), dcSet.end());
+
+    vector<Cube> result;
+    vector<char> covered(cover.size(), 0);
+    CubeArray cubes(cover);
+    vector<uint32_t> swallowed;
+    for (size_t idx : largestFirst(cover)) {
+        if (covered[idx]) continue;
+        Cube c = cover[idx];
+        if (budget && !budget->spend()) {
+            result.push_back(c);
+            continue;
+        }
+
+        int scores[64] = {0};
+        for (size_t j = 0; j < cover.size(); j++) {
+            uint64_t conflict = (cover[j].value ^ c.value) & cover[j].mask & c.mask;
+            if (!covered[j] && conflict && (conflict & (conflict - 1)) == 0) scores[__builtin_ctzll(conflict)]++;
+        }
+        vector<int> raise;
+        for (uint64_t bits = c.mask; bits; bits &= bits - 1) raise.push_back(__builtin_ctzll(bits));
+        std::stable_sort(raise.begin(), raise.end(), [&](int a, int b) { return scores[a] > scores[b]; });
+
+        for (int b : raise) {
+            uint64_t bit = uint64_t(1) << b;
+            Cube raised = {c.mask & ~bit, c.value & ~bit};
+            if (coverContainsCube(function, raised)) c = raised;
+        }
+
+        result.push_back(c);
+        swallowed.clear();
+        findCubes(cubes, c, CubeRelation::ContainedBy, swallowed);
+        for (uint32_t j : swallowed) covered[j] = 1;
+    }
+    return result;
+}
+
+// IRREDUNDANT: drop cubes covered by the rest of the cover, smallest first.
+// Cubes reached after the budget runs out are kept unchecked.
+static vector<Cube> irredundant(const vector<Cube>& cover, const vector<Cube>& dcSet, SolveBudget* budget) {
+    vector<Cube> current(cover);
+    vector<size_t> order = largestFirst(current);
+    std::reverse(order.begin(), order.end());
+    vector<char> removed(current.size(), 0);
+    for (size_t idx : order) {
+        if (budget && !budget->spend()) break;
+        vector<Cube> others;
+        for (size_t j = 0; j < current.size(); j++) {
+            if (j != idx && !removed[j]) others.push_back(current[j]);
+        }
+        others.insert(others.end(), dcSet.begin(), dcSet.end());
+        if (coverContainsCube(others, current[idx])) removed[idx] = 1;
+    }
+    vector<Cube> result;
+    for (size_t i = 0; i < current.size(); i++) {
+        if (!removed[i]) result.push_back(current[i]);
+    }
+    return result;
+}
+
+// REDUCE: shrink each cube to the smallest cube holding the minterms only it
+// covers, so the next EXPAND can move it somewhere better. Cubes reached after
+// the budget runs out are kept as they are.
+static vector<Cube> reduce(const vector<Cube>& cover, const vector<Cube>& dcSet, SolveBudget* budget) {
+    vector<Cube> current(cover);
+    vector<char> removed(current.size(), 0);
+    for (size_t idx : largestFirst(cover)) {
+        if (budget && !budget->spend()) break;
+        vector<Cube> others = withoutIndex(current, idx, dcSet);
+        Cube unique;
+        if (!complementSupercube(cofactor(others, current[idx]), unique)) {
+            removed[idx] = 1;
+            current[idx] = {0, 0};
+            continue;
+        }
+        current[idx] = {current[idx].mask | unique.mask, current[idx].value | unique.value};
+    }
+    vector<Cube> result;
+    for (size_t i = 0; i < current.size(); i++) {
+        if (!removed[i]) result.push_back(current[i]);
+    }
+    return result;
+}
+
+static std::pair<size_t, size_t> coverCost(const vector<Cube>& cover) {
+    size_t literals = 0;
+    for (const Cube& c : cover) literals += literalCount(c);
+    return {cover.size(), literals};
+}
+
+vector<Cube> minimizeEspresso(const vector<Cube>& onSet, const vector<Cube>& dcSet, SolveBudget* budget) {
+    // Start from the on-set with single-cube containment removed, as far as
+    // the budget allows
+    vector<Cube> cover;
+    CubeArray kept;
+    for (size_t idx : largestFirst(onSet)) {
+        if ((!budget || budget->spend()) && anyCubeContains(kept, onSet[idx])) continue;
+        kept.push_back(onSet[idx]);
+        cover.push_back(onSet[idx]);
+    }
+
+    cover = irredundant(expand(cover, dcSet, budget), dcSet, budget);
+    auto cost = coverCost(cover);
+    while (!cover.empty() && !(budget && budget->expired())) {
+        vector<Cube> candidate = irredundant(expand(reduce(cover, dcSet, budget), dcSet, budget), dcSet, budget);
+        auto candidateCost = coverCost(candidate);
+        if (candidateCost >= cost) break;
+        cover.swap(candidate);
+        cost = candidateCost;
+    }
+    return cover;
+}
@@ -0,0 +1,23 @@
+#ifndef ESPRESSO_HPP
+#define ESPRESSO_HPP
+
+#include "truth_table.hpp"
+
+class SolveBudget;
+
+// Heuristic two-level minimization in the spirit of Espresso-II. Works purely on
+// cube lists: implicant checks are tautology tests on cofactors, so neither the
+// truth table nor the full prime set is ever built and memory stays proportional
+// to the cover size. Suited to 20-64 variable functions where exact methods blow up.
+
+// Minimize the function whose on-set is `onSet` with don't-cares `dcSet`. Every
+// cube checked for containment, expanded, checked for redundancy or reduced
+// spends a step of `budget`; once it runs out the remaining cubes are left as
+// they are and the best cover so far is returned.
+vector<Cube> minimizeEspresso(const vector<Cube>& onSet, const vector<Cube>& dcSet, SolveBudget* budget = nullptr);
+
+// Cube-list primitives shared with the other engines
+bool isTautology(const vector<Cube>& cover);
+bool coverContainsCube(const vector<Cube>& cover, const Cube& cube);
+
+#endif // ESPRESSO_HPP
@@ -0,0 +1,359 @@
+#include "implicit_primes.hpp"
+#include "bdd.hpp"
+#include "zdd.hpp"
+#include "cover_solver.hpp"
+#include "cube_kernels.hpp"
+#include "espresso.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+// Largest cyclic core covered exactly; bigger ones fall back to Espresso
+static const uint64_t kCoreColumnLimit = uint64_t(1) << 16;
+static const double kCoreRowLimit = double(uint64_t(1) << 20);
+static const double kCoreMatrixLimit = double(uint64_t(1) << 28);
+
+namespace {
+
+class ImplicitPrimes {
+public:
+    ImplicitPrimes(const vector<int>& levelBits, SolveBudget* budget)
+        : bdd(levelBits), zdd(levelBits), budget(budget), levelCount(levelBits.size()) {
+        bdd.setBudget(budget);
+        zdd.setBudget(budget);
+    }
+
+    // Coudert-Madre: P(f) = P(f0 f1) + x' (P(f0) - P(f0 f1)) + x (P(f1) - P(f0 f1))
+    Zdd::Ref primes(Bdd::Ref f) {
+        if (f == Bdd::Zero) return Zdd::Empty;
+        if (f == Bdd::One) return Zdd::Base;
+        auto cached = primeCache.find(f);
+        if (cached != primeCache.end()) return cached->second;
+        if (budget && !budget->spend()) throw SolveBudgetExpired();
+
+        uint32_t level = bdd.topLevel(f);
+        Bdd::Ref f0 = bdd.cofactor(f, level, false), f1 = bdd.cofactor(f, level, true);
+        Zdd::Ref shared = primes(bdd.bddAnd(f0, f1));
+        Zdd::Ref negative = zdd.setDifference(primes(f0), shared);
+        Zdd::Ref positive = zdd.setDifference(primes(f1), shared);
+        Zdd::Ref result = zdd.makeNode(2 * level, zdd.makeNode(2 * level + 1, shared, negative), positive);
+        primeCache[f] = result;
+        return result;
+    }
+
+    // Minterms covered by at least one / at least two cubes of the set
+    std::pair<Bdd::Ref, Bdd::Ref> coverage(Zdd::Ref s) {
+        if (s == Zdd::Empty) return {Bdd::Zero, Bdd::Zero};
+        if (s == Zdd::Base) return {Bdd::One, Bdd::Zero};
+        auto cached = coverageCache.find(s);
+        if (cached != coverageCache.end()) return cached->second;
+
+        uint32_t level = zddLevel(s);
+        Zdd::Ref positive, negative, free;
+        split(s, level, positive, negative, free);
+        auto p = coverage(positive), n = coverage(negative), f = coverage(free);
+        Bdd::Ref once0 = bdd.bddOr(n.first, f.first), once1 = bdd.bddOr(p.first, f.first);
+        Bdd::Ref twice0 = bdd.bddOr(bdd.bddOr(n.second, f.second), bdd.bddAnd(n.first, f.first));
+        Bdd::Ref twice1 = bdd.bddOr(bdd.bddOr(p.second, f.second), bdd.bddAnd(p.first, f.first));
+        std::pair<Bdd::Ref, Bdd::Ref> result(bdd.branch(level, once0, once1), bdd.branch(level, twice0, twice1));
+        coverageCache[s] = result;
+        return result;
+    }
+
+    // Cubes of the set that intersect g
+    Zdd::Ref select(Zdd::Ref s, Bdd::Ref g) {
+        if (s == Zdd::Empty || g == Bdd::Zero) return Zdd::Empty;
+        if (s == Zdd::Base) return Zdd::Base;
+        uint64_t key = (uint64_t(s) << 32) | g;
+        auto cached = selectCache.find(key);
+        if (cached != selectCache.end()) return cached->second;
+
+        Zdd::Ref result;
+        uint32_t level = std::min(zddLevel(s), bdd.topLevel(g));
+        Bdd::Ref g0 = bdd.cofactor(g, level, false), g1 = bdd.cofactor(g, level, true);
+        if (zddLevel(s) != level) {
+            // No cube constrains this variable: either value will do
+            result = select(s, bdd.bddOr(g0, g1));
+        } else {
+            Zdd::Ref positive, negative, free;
+            split(s, level, positive, negative, free);
+            Zdd::Ref low = zdd.makeNode(2 * level + 1, select(free, bdd.bddOr(g0, g1)), select(negative, g0));
+            result = zdd.makeNode(2 * level, low, select(positive, g1));
+        }
+        selectCache[key] = result;
+        return result;
+    }
+
+    // Core primes that another core prime dominates on `region`: it covers every
+    // region minterm of theirs with no more literals (ties go to the smaller
+    // cube, so one of two equal primes stays). Only a prime whose region part
+    // lies in a smaller cube can be dominated, since no prime contains another;
+    // those candidates are found implicitly, and only they are expanded to
+    // look up the core primes containing that smaller cube.
+    Zdd::Ref dominated(Zdd::Ref core, Bdd::Ref region) {
+        Zdd::Ref candidates = Zdd::Empty;
+        for (uint32_t level = 0; level < levelCount; level++) {
+            std::unordered_map<Zdd::Ref, Zdd::Ref> freeCache;
+            Zdd::Ref free = freeAt(core, level, freeCache);
+            if (free == Zdd::Empty) continue;
+            Bdd::Ref x = bdd.variable(bdd.getLevelBits()[level]);
+            // Free at x and meeting the region on both sides of it: no shrinking here
+            Zdd::Ref both = select(select(free, bdd.bddAnd(region, x)), bdd.bddAnd(region, Bdd::negate(x)));
+            candidates = zdd.setUnion(candidates, zdd.setDifference(free, both));
+        }
+
+        vector<Cube> shrinking, containing;
+        zdd.collectCubes(candidates, shrinking);
+        Zdd::Ref result = Zdd::Empty;
+        std::unordered_map<Bdd::Ref, Cube> hullCache;
+        for (const Cube& p : shrinking) {
+            // Out of budget: the primes found so far are still safe to drop
+            if (budget && !budget->spend()) break;
+            Bdd::Ref part = bdd.bddAnd(region, bdd.cube(p));
+            bool drop = part == Bdd::Zero; // covers only don't-cares or done minterms
+            if (!drop) {
+                std::unordered_map<Zdd::Ref, Zdd::Ref> containCache;
+                containing.clear();
+                zdd.collectCubes(supersets(core, supercube(part, hullCache), containCache), containing);
+                int literals = __builtin_popcountll(p.mask);
+                for (const Cube& q : containing) {
+                    int qLiterals = __builtin_popcountll(q.mask);
+                    if (q == p || qLiterals > literals || (qLiterals == literals && !(q < p))) continue;
+                    drop = true;
+                    break;
+                }
+            }
+            if (drop) result = zdd.setUnion(result, single(p));
+        }
+        return result;
+    }
+
+    Bdd bdd;
+    Zdd zdd;
+
+private:
+    // Cubes of the set with no literal at `level`
+    Zdd::Ref freeAt(Zdd::Ref s, uint32_t level, std::unordered_map<Zdd::Ref, Zdd::Ref>& cache) {
+        if (zddLevel(s) > level) return s;
+        Zdd::Ref positive, negative, free;
+        if (zddLevel(s) == level) {
+            split(s, level, positive, negative, free);
+            return free;
+        }
+        auto cached = cache.find(s);
+        if (cached != cache.end()) return cached->second;
+        Zdd::Ref result = zdd.makeNode(zdd.varOf(s), freeAt(zdd.lowOf(s), level, cache),
+                                       freeAt(zdd.highOf(s), level, cache));
+        cache[s] = result;
+        return result;
+    }
+
+    // Cubes of the set that contain `cube`: where it has a literal they have the
+    // same one or none, and elsewhere none
+    Zdd::Ref supersets(Zdd::Ref s, const Cube& cube, std::unordered_map<Zdd::Ref, Zdd::Ref>& cache) {
+        if (s <= Zdd::Base) return s;
+        auto cached = cache.find(s);
+        if (cached != cache.end()) return cached->second;
+
+        uint32_t level = zddLevel(s);
+        uint64_t bit = uint64_t(1) << bdd.getLevelBits()[level];
+        Zdd::Ref positive, negative, free;
+        split(s, level, positive, negative, free);
+        Zdd::Ref result = supersets(free, cube, cache);
+        if (cube.mask & bit) {
+            if (cube.value & bit) result = zdd.makeNode(2 * level, result, supersets(positive, cube, cache));
+            else result = zdd.makeNode(2 * level + 1, result, supersets(negative, cube, cache));
+        }
+        cache[s] = result;
+        return result;
+    }
+
+    // Smallest cube containing every minterm of g, which must not be Zero
+    Cube supercube(Bdd::Ref g, std::unordered_map<Bdd::Ref, Cube>& cache) {
+        if (g == Bdd::One) return Cube{0, 0};
+        auto cached = cache.find(g);
+        if (cached != cache.end()) return cached->second;
+
+        uint32_t level = bdd.topLevel(g);
+        uint64_t bit = uint64_t(1) << bdd.getLevelBits()[level];
+        Bdd::Ref g0 = bdd.cofactor(g, level, false), g1 = bdd.cofactor(g, level, true);
+        Cube result;
+        if (g0 == Bdd::Zero) {
+            result = supercube(g1, cache);
+            result.mask |= bit;
+            result.value |= bit;
+        } else if (g1 == Bdd::Zero) {
+            result = supercube(g0, cache);
+            result.mask |= bit;
+        } else {
+            Cube a = supercube(g0, cache), b = supercube(g1, cache);
+            uint64_t mask = a.mask & b.mask & ~(a.value ^ b.value);
+            result = Cube{mask, a.value & mask};
+        }
+        cache[g] = result;
+        return result;
+    }
+
+    // The set holding just `cube`
+    Zdd::Ref single(const Cube& cube) {
+        Zdd::Ref result = Zdd::Base;
+        for (uint32_t level = levelCount; level-- > 0;) {
+            uint64_t bit = uint64_t(1) << bdd.getLevelBits()[level];
+            if (cube.mask & bit) result = zdd.makeNode((cube.value & bit) ? 2 * level : 2 * level + 1, Zdd::Empty, result);
+        }
+        return result;
+    }
+
+    uint32_t zddLevel(Zdd::Ref s) const {
+        return s <= Zdd::Base ? levelCount : zdd.varOf(s) / 2;
+    }
+
+    // Cubes with x, with x' and without x at `level`
+    void split(Zdd::Ref s, uint32_t level, Zdd::Ref& positive, Zdd::Ref& negative, Zdd::Ref& free) const {
+        positive = negative = Zdd::Empty;
+        free = s;
+        if (free > Zdd::Base && zdd.varOf(free) == 2 * level) {
+            positive = zdd.highOf(free);
+            free = zdd.lowOf(free);
+        }
+        if (free > Zdd::Base && zdd.varOf(free) == 2 * level + 1) {
+            negative = zdd.highOf(free);
+            free = zdd.lowOf(free);
+        }
+    }
+
+    SolveBudget* budget;
+    uint32_t levelCount;
+    std::unordered_map<Bdd::Ref, Zdd::Ref> primeCache;
+    std::unordered_map<Zdd::Ref, std::pair<Bdd::Ref, Bdd::Ref>> coverageCache;
+    std::unordered_map<uint64_t, Zdd::Ref> selectCache;
+};
+
+} // namespace
+
+// Covering rows built between two checks of the solve budget
+static const size_t kRowBudgetInterval = 1024;
+
+// Exact cover of the core minterms by the explicit core primes
+static vector<Cube> coverCore(const vector<Cube>& primes, const vector<uint64_t>& minterms, bool& provenOptimal,
+                              uint64_t& lowerBound, SolveBudget* budget) {
+    CubeArray columns(primes);
+    vector<vector<uint32_t>> rows(minterms.size());
+    for (size_t r = 0; r < minterms.size(); r++) {
+        if (budget && r % kRowBudgetInterval == 0 && !budget->spend()) throw SolveBudgetExpired();
+        findCubes(columns, Cube{~uint64_t(0), minterms[r]}, CubeRelation::Contains, rows[r]);
+    }
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    vector<uint64_t> costs;
+    for (const Cube& p : primes) costs.push_back((uint64_t(1) << 32) + __builtin_popcountll(p.mask));
+    CoverSolution solution = solveUnateCover(rows, costs, kDefaultCoverNodeLimit, budget);
+    provenOptimal = solution.provenOptimal;
+    lowerBound = solution.lowerBound >> 32; // one cube per column in the high word
+
+    vector<Cube> cover;
+    for (uint32_t c : solution.columns) cover.push_back(primes[c]);
+    return cover;
+}
+
+// The stages after sifting; every BDD/ZDD operation and the core row build may
+// throw SolveBudgetExpired
+static vector<Cube> coverImplicit(ImplicitPrimes& implicit, const vector<Cube>& onSet, const vector<Cube>& dcSet,
+                                  bool* provenOptimal, ImplicitPrimeStats* stats, SolveBudget* budget) {
+    Bdd& bdd = implicit.bdd;
+    Zdd& zdd = implicit.zdd;
+    Bdd::Ref function = bdd.fromCubes(onSet);
+    Bdd::Ref dontCares = bdd.bddAnd(bdd.fromCubes(dcSet), Bdd::negate(function));
+    Zdd::Ref primes = implicit.primes(bdd.bddOr(function, dontCares));
+    uint64_t primeCount = zdd.count(primes);
+
+    // Peel off essential primes (the only prime on some uncovered minterm) and
+    // drop primes left with nothing to cover; once none is essential, drop the
+    // dominated primes, which may leave new essentials. Stops at the cyclic core
+    // or when the budget runs out (every prime still reaching the region stays
+    // in the core).
+    Zdd::Ref essentials = Zdd::Empty, core = primes;
+    Bdd::Ref region = function;
+    uint64_t dominatedCount = 0;
+    while (!budget || budget->spend()) {
+        auto covered = implicit.coverage(core);
+        Bdd::Ref once = bdd.bddAnd(region, bdd.bddAnd(covered.first, Bdd::negate(covered.second)));
+        Zdd::Ref found = implicit.select(core, once);
+        if (found == Zdd::Empty) {
+            Zdd::Ref dominated = implicit.dominated(core, region);
+            if (dominated == Zdd::Empty) break;
+            dominatedCount += zdd.count(dominated);
+            core = zdd.setDifference(core, dominated);
+            continue;
+        }
+        essentials = zdd.setUnion(essentials, found);
+        core = zdd.setDifference(core, found);
+        region = bdd.bddAnd(region, Bdd::negate(implicit.coverage(found).first));
+        core = implicit.select(core, region);
+    }
+
+    vector<Cube> cover;
+    zdd.collectCubes(essentials, cover);
+    bool proven = true;
+    uint64_t coreCount = zdd.count(core);
+    // Each essential is alone on some minterm; the core needs at least one more cube
+    uint64_t lowerBound = cover.size() + (region != Bdd::Zero ? 1 : 0);
+    if (region != Bdd::Zero) {
+        double rowCount = bdd.satCount(region);
+        bool expired = budget && budget->expired();
+        if (!expired && coreCount <= kCoreColumnLimit && rowCount <= kCoreRowLimit &&
+            coreCount * rowCount <= kCoreMatrixLimit) {
+            vector<Cube> corePrimes;
+            vector<uint64_t> minterms;
+            zdd.collectCubes(core, corePrimes);
+            bdd.collectMinterms(region, minterms);
+            uint64_t coreBound;
+            vector<Cube> chosen = coverCore(corePrimes, minterms, proven, coreBound, budget);
+            lowerBound = cover.size() + coreBound;
+            cover.insert(cover.end(), chosen.begin(), chosen.end());
+        } else {
+            // Too big to enumerate, or out of budget: let Espresso cover the core
+            // region, with the part the essentials already cover as don't-cares
+            vector<Cube> done = bdd.isop(bdd.bddOr(bdd.bddAnd(function, Bdd::negate(region)), dontCares));
+            vector<Cube> rest = minimizeEspresso(bdd.isop(region), done, budget);
+            cover.insert(cover.end(), rest.begin(), rest.end());
+            proven = false;
+        }
+    }
+
+    if (provenOptimal) *provenOptimal = proven;
+    if (stats) {
+        stats->primeCount = primeCount;
+        stats->essentialCount = zdd.count(essentials);
+        stats->dominatedCount = dominatedCount;
+        stats->corePrimeCount = coreCount;
+        stats->coverLowerBound = lowerBound;
+        stats->peakBddNodes = bdd.nodeCount();
+        stats->peakZddNodes = zdd.nodeCount();
+    }
+    return cover;
+}
+
+vector<Cube> minimizeImplicit(const vector<Cube>& onSet, const vector<Cube>& dcSet, int varCount,
+                              bool* provenOptimal, ImplicitPrimeStats* stats, SolveBudget* budget) {
+    vector<Cube> careCubes(onSet);
+    careCubes.insert(careCubes.end(), dcSet.begin(), dcSet.end());
+    ImplicitPrimes implicit(siftVariableOrder(careCubes, varCount, budget), budget);
+    Bdd& bdd = implicit.bdd;
+    Zdd& zdd = implicit.zdd;
+    try {
+        return coverImplicit(implicit, onSet, dcSet, provenOptimal, stats, budget);
+    } catch (const SolveBudgetExpired&) {
+        // Out of budget with no complete cover yet; Espresso keeps the cover as
+        // it stands, which is little more than the input cubes by now
+        if (provenOptimal) *provenOptimal = false;
+        if (stats) {
+            *stats = ImplicitPrimeStats();
+            stats->peakBddNodes = bdd.nodeCount();
+            stats->peakZddNodes = zdd.nodeCount();
+        }
+        return minimizeEspresso(onSet, dcSet, budget);
+    }
+}
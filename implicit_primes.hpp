@@ -0,0 +1,34 @@
+#ifndef IMPLICIT_PRIMES_HPP
+#define IMPLICIT_PRIMES_HPP
+
+#include "truth_table.hpp"
+
+class SolveBudget;
+
+// Exact minimization with an implicit prime set. The function is built as a BDD,
+// its primes are generated straight into a ZDD (Coudert-Madre), and essential
+// primes are peeled off with BDD/ZDD operations, alternating with column
+// dominance, until only the cyclic core is left; only that core (and the few
+// primes dominance has to check) is ever expanded into explicit cubes.
+
+struct ImplicitPrimeStats {
+    uint64_t primeCount = 0;     // all prime implicants (saturating)
+    uint64_t essentialCount = 0; // primes fixed by the implicit reduction
+    uint64_t dominatedCount = 0; // primes dropped by column dominance
+    uint64_t corePrimeCount = 0; // primes left for explicit covering
+    uint64_t coverLowerBound = 0; // no cover has fewer cubes
+    size_t peakBddNodes = 0;
+    size_t peakZddNodes = 0;
+};
+
+// Minimum cover (fewest cubes, then fewest literals) of the function given by
+// `onSet`, free to cover any of `dcSet`. Primes are those of on-set plus
+// don't-cares; only on-set minterms need covering. `provenOptimal` is false if
+// the covering search hit its node limit or `budget`, or the core was too large
+// to cover exactly. The budget bounds every stage; if it runs out before the
+// primes are all generated, the result is Espresso's cover as it stands then.
+vector<Cube> minimizeImplicit(const vector<Cube>& onSet, const vector<Cube>& dcSet, int varCount,
+                              bool* provenOptimal = nullptr, ImplicitPrimeStats* stats = nullptr,
+                              SolveBudget* budget = nullptr);
+
+#endif // IMPLICIT_PRIMES_HPP
@@ -0,0 +1,52 @@
+#include "kmap.hpp"
+#include <algorithm>
+
+static int grayToIndex(uint64_t gray) {
+    uint64_t index = gray;
+    for (int shift = 1; shift < 64; shift <<= 1) index ^= index >> shift;
+    return static_cast<int>(index);
+}
+
+KMap::KMap() : colBits(0) {}
+
+KMap::KMap(const TruthTable& table, const TruthTable& dontCares)
+    : table(table), dontCares(dontCares), colBits(table.getVariableCount() / 2) {}
+
+uint64_t KMap::getMinterm(int row, int col) const {
+    uint64_t grayRow = row ^ (row >> 1), grayCol = col ^ (col >> 1);
+    return (grayRow << colBits) | grayCol;
+}
+
+std::pair<int, int> KMap::getCell(uint64_t minterm) const {
+    return {grayToIndex(minterm >> colBits), grayToIndex(minterm & ((uint64_t(1) << colBits) - 1))};
+}
+
+KMapCubeGroup KMap::makeGroup(const Cube& cube) const {
+    KMapCubeGroup group;
+    group.cube = cube;
+    if (getVariableCount() <= kMaxDisplayVariables) {
+        group.cells = TruthTable(getVariableCount());
+        rasterizeCubes({cube}, group.cells);
+    }
+    return group;
+}
+
+vector<vector<bool>> KMap::toGrid() const {
+    vector<vector<bool>> grid(getRowCount(), vector<bool>(getColumnCount(), false));
+    for (int i = 0; i < getRowCount(); i++) {
+        for (int j = 0; j < getColumnCount(); j++) grid[i][j] = get(i, j);
+    }
+    return grid;
+}
+
+vector<std::pair<int, int>> KMap::getCells(const KMapCubeGroup& group) const {
+    vector<std::pair<int, int>> cells;
+    const vector<uint64_t>& words = group.cells.words();
+    for (size_t w = 0; w < words.size(); w++) {
+        for (uint64_t bits = words[w]; bits; bits &= bits - 1) {
+            cells.push_back(getCell((uint64_t(w) << 6) | __builtin_ctzll(bits)));
+        }
+    }
+    std::sort(cells.begin(), cells.end());
+    return cells;
+}
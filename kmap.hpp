@@ -0,0 +1,56 @@
+#ifndef KMAP_HPP
+#define KMAP_HPP
+
+#include "truth_table.hpp"
+#include <utility>
+
+// Largest variable count the K-map grid is drawn for (a 16x16 map)
+const int kMaxDisplayVariables = 8;
+
+// A group of the minimal cover as a bit set in minterm space: bit m of `cells`
+// is set when the cell of minterm m lies in the group. Cells are only filled
+// for drawable maps (up to kMaxDisplayVariables); the cube is always set.
+struct KMapCubeGroup {
+    Cube cube;
+    TruthTable cells;
+
+    bool covers(uint64_t minterm) const { return cells.get(minterm); }
+    uint64_t size() const { return cells.count(); }
+};
+
+// K-map over a bit-packed truth table. Rows hold the leading variables and
+// columns the trailing ones, both in Gray code order, so cell (i, j) is minterm
+// (gray(i) << colBits) | gray(j). Up to 6 variables the whole map is one word.
+// Don't-care cells, if any, are kept in a second table of the same layout.
+class KMap {
+public:
+    KMap();
+    explicit KMap(const TruthTable& table, const TruthTable& dontCares = TruthTable());
+
+    int getVariableCount() const { return table.getVariableCount(); }
+    int getRowCount() const { return 1 << (getVariableCount() - colBits); }
+    int getColumnCount() const { return 1 << colBits; }
+
+    uint64_t getMinterm(int row, int col) const;
+    std::pair<int, int> getCell(uint64_t minterm) const;
+    bool get(int row, int col) const { return table.get(getMinterm(row, col)); }
+    bool isDontCare(int row, int col) const { return hasDontCares() && dontCares.get(getMinterm(row, col)); }
+    const TruthTable& getTable() const { return table; }
+    // Empty (no variables) when the map has no don't-cares
+    const TruthTable& getDontCares() const { return dontCares; }
+    bool hasDontCares() const { return dontCares.getVariableCount() > 0; }
+
+    // Group of a cube, with its cells rasterized when the map is drawable
+    KMapCubeGroup makeGroup(const Cube& cube) const;
+
+    // Adapters to the older grid and cell-list forms
+    vector<vector<bool>> toGrid() const;
+    vector<std::pair<int, int>> getCells(const KMapCubeGroup& group) const;
+
+private:
+    TruthTable table;
+    TruthTable dontCares;
+    int colBits;
+};
+
+#endif // KMAP_HPP
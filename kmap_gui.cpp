@@ -115,7 +115,7 @@ void KMapGUI::setupUI() {
     // Add variable count controls
     useVariableCountCheckBox = new QCheckBox("Force variable count:");
     variableCountSpinBox = new QSpinBox();
-    variableCountSpinBox->setRange(2, 4);
+    variableCountSpinBox->setRange(2, kMaxDisplayVariables);
     variableCountSpinBox->setValue(4);
     variableCountSpinBox->setEnabled(false); // Initially disabled
     
@@ -342,20 +342,39 @@ void KMapGUI::solveEquation() {
     string equation = equationInput->text().toStdString();
     
     try {
-        if (solver) {
-            delete solver;
-        }
-        
         // Create solver with or without variable count specification
+        KMapSolver* parsed;
         if (useVariableCountCheckBox->isChecked()) {
             int varCount = variableCountSpinBox->value();
-            solver = new KMapSolver(equation, varCount);
+            parsed = new KMapSolver(equation, varCount);
         } else {
-            solver = new KMapSolver(equation);
+            parsed = new KMapSolver(equation);
+        }
+        
+        // An edit over the same variables goes to the current solver, which
+        // repairs its last result instead of solving from scratch
+        if (solver && solver->getVariables() == parsed->getVariables()) {
+            delete parsed;
+            solver->setEquation(equation);
+        } else {
+            delete solver;
+            solver = parsed;
+        }
+        
+        if (solver->getVariableCount() < 2) {
+            throw std::runtime_error("Only 2 to " + std::to_string(kMaxTruthTableVariables) + " variables are supported");
         }
         
-        // Generate the K-map
-        auto kmap = solver->solve();
+        // One solve pass feeds the table, the torus view and the expression
+        std::shared_ptr<const SolveResult> result = solver->getResult();
+        
+        // Wider functions are minimized but not drawn
+        if (solver->getVariableCount() > kMaxDisplayVariables) {
+            clearResults();
+            minimizedLabel->setText(QString::fromStdString("Minimized Expression: " + result->expression +
+                "\n(K-map views are limited to " + std::to_string(kMaxDisplayVariables) + " variables)"));
+            return;
+        }
         
         // Clear only the table view (not the 3D view)
         if (kmapTable) {
@@ -369,7 +388,7 @@ void KMapGUI::solveEquation() {
         }
         
         // Update both views
-        updateKMapTable(kmap, solver->getVariables());
+        updateKMapTable(*result);
         
         // Completely clean up old entities before creating new ones
         for (auto entity : cellEntities) {
@@ -382,11 +401,10 @@ void KMapGUI::solveEquation() {
         torusTransform = nullptr;
         
         // Now update the torus view with the new data
-        updateTorusView(kmap, solver->getVariables());
+        updateTorusView(*result);
         
         // Display the minimized expression
-        string minimized = solver->getMinimizedExpression();
-        minimizedLabel->setText(QString::fromStdString("Minimized Expression: " + minimized));
+        minimizedLabel->setText(QString::fromStdString("Minimized Expression: " + result->expression));
         
         // Restore focus to ensure keyboard controls work
         this->setFocus();
@@ -396,7 +414,7 @@ void KMapGUI::solveEquation() {
     }
 }
 
-QColor KMapGUI::getCellColor(int row, int col, const std::vector<KMapGroup>& groups) {
+QColor KMapGUI::getCellColor(uint64_t minterm, const std::vector<KMapCubeGroup>& groups) {
     // List of distinct colors for groups
     static const QList<QColor> colors = {
         QColor(255, 200, 200), // Light red
@@ -412,7 +430,7 @@ QColor KMapGUI::getCellColor(int row, int col, const std::vector<KMapGroup>& gro
     std::vector<int> matchingGroups;
     // Find all groups that contain this cell
     for (size_t i = 0; i < groups.size(); ++i) {
-        if (std::find(groups[i].cells.begin(), groups[i].cells.end(), std::make_pair(row, col)) != groups[i].cells.end()) {
+        if (groups[i].covers(minterm)) {
             matchingGroups.push_back(i);
         }
     }
@@ -438,22 +456,25 @@ QColor KMapGUI::getCellColor(int row, int col, const std::vector<KMapGroup>& gro
     }
 }
 
-void KMapGUI::updateKMapTable(const std::vector<std::vector<bool>>& kmap, const std::vector<char>& variables) {
-    int rows = kmap.size();
-    int cols = kmap[0].size();
-    
-    // Get the groups for highlighting
-    std::vector<KMapGroup> groups = solver->getMinimalCoverGroups();
+void KMapGUI::updateKMapTable(const SolveResult& result) {
+    const KMap& kmap = result.kmap;
+    const std::vector<char>& variables = result.variables;
+    const std::vector<KMapCubeGroup>& groups = result.groups;
+    int rows = kmap.getRowCount();
+    int cols = kmap.getColumnCount();
     
     // Set table dimensions
     kmapTable->setRowCount(rows);
     kmapTable->setColumnCount(cols);
     
+    // Rows hold the leading variables, columns the trailing ones
+    int numColVars = variables.size() / 2;
+    int numRowVars = variables.size() - numColVars;
+    
     // Set column headers (Gray code in binary)
     for (int j = 0; j < cols; j++) {
         int gray_j = j ^ (j >> 1);
         // Convert to binary string based on number of column variables
-        int numColVars = (variables.size() > 2) ? (variables.size() - 2) : 1;
         QString binaryStr = "";
         for (int bit = numColVars - 1; bit >= 0; bit--) {
             binaryStr += (gray_j & (1 << bit)) ? "1" : "0";
@@ -464,20 +485,23 @@ void KMapGUI::updateKMapTable(const std::vector<std::vector<bool>>& kmap, const
     // Set row headers (Gray code)
     for (int i = 0; i < rows; i++) {
         int gray_i = i ^ (i >> 1);
-        string row_label = (gray_i & 2 ? "1" : "0") + string(gray_i & 1 ? "1" : "0");
+        string row_label;
+        for (int bit = numRowVars - 1; bit >= 0; bit--) {
+            row_label += (gray_i & (1 << bit)) ? "1" : "0";
+        }
         kmapTable->setVerticalHeaderItem(i, new QTableWidgetItem(QString::fromStdString(row_label)));
     }
     
     // Fill in the K-map values and highlight groups
     for (int i = 0; i < rows; i++) {
         for (int j = 0; j < cols; j++) {
-            QTableWidgetItem* item = new QTableWidgetItem(kmap[i][j] ? "1" : "0");
+            QTableWidgetItem* item = new QTableWidgetItem(kmap.get(i, j) ? "1" : kmap.isDontCare(i, j) ? "X" : "0");
             item->setTextAlignment(Qt::AlignCenter);
             kmapTable->setItem(i, j, item);
             
-            // Highlight cell based on its groups
-            if (kmap[i][j]) {
-                QColor color = getCellColor(i, j, groups);
+            // Highlight cell based on its groups, including don't-cares a group took in
+            if (kmap.get(i, j) || kmap.isDontCare(i, j)) {
+                QColor color = getCellColor(kmap.getMinterm(i, j), groups);
                 item->setBackground(color);
             }
         }
@@ -495,12 +519,10 @@ void KMapGUI::updateKMapTable(const std::vector<std::vector<bool>>& kmap, const
     }
     
     // Add variable mapping labels
-    string rowVars = "Rows: " + string(1, variables[0]);
-    if (variables.size() > 1) rowVars += variables[1];
+    string rowVars = "Rows: " + string(variables.begin(), variables.begin() + numRowVars);
     rowVars += " (in Gray code order)";
     
-    string colVars = "Columns: " + string(1, variables[2]);
-    if (variables.size() > 3) colVars += variables[3];
+    string colVars = "Columns: " + string(variables.begin() + numRowVars, variables.end());
     colVars += " (in Gray code order)";
     
     QLabel* varMappingLabel = new QLabel(QString::fromStdString(rowVars + "\n" + colVars));
@@ -518,9 +540,9 @@ void KMapGUI::updateKMapTable(const std::vector<std::vector<bool>>& kmap, const
         for (size_t i = 0; i < groups.size(); ++i) {
             QLabel* colorBox = new QLabel();
             colorBox->setFixedSize(20, 20);
-            colorBox->setStyleSheet(QString("background-color: %1").arg(QColor(getCellColor(groups[i].cells[0].first, groups[i].cells[0].second, groups)).name()));
+            colorBox->setStyleSheet(QString("background-color: %1").arg(QColor(getCellColor(groups[i].cube.value, groups)).name()));
             
-            QLabel* termLabel = new QLabel(QString::fromStdString(groups[i].term));
+            QLabel* termLabel = new QLabel(QString::fromStdString(solver->getTerm(groups[i].cube)));
             
             legendLayout->addWidget(colorBox, i+1, 0);
             legendLayout->addWidget(termLabel, i+1, 1);
@@ -532,18 +554,19 @@ void KMapGUI::updateKMapTable(const std::vector<std::vector<bool>>& kmap, const
     }
 }
 
-void KMapGUI::updateTorusView(const std::vector<std::vector<bool>>& kmap, const std::vector<char>& variables) {
+void KMapGUI::updateTorusView(const SolveResult& result) {
+    const KMap& kmap = result.kmap;
+    const std::vector<char>& variables = result.variables;
+    const std::vector<KMapCubeGroup>& groups = result.groups;
+
     // Make sure rootEntity exists and is properly set
     if (!rootEntity) {
         rootEntity = new Qt3DCore::QEntity();
         torus3DWindow->setRootEntity(rootEntity);
     }
     
-    int rows = kmap.size();
-    int cols = kmap[0].size();
-    
-    // Get the groups for coloring
-    std::vector<KMapGroup> groups = solver->getMinimalCoverGroups();
+    int rows = kmap.getRowCount();
+    int cols = kmap.getColumnCount();
     
     // CREATE A PROPER K-MAP TORUS TEXTURE
     // The key insight: We need to create a texture where the UV coordinates
@@ -554,6 +577,10 @@ void KMapGUI::updateTorusView(const std::vector<std::vector<bool>>& kmap, const
     // - Vertically adjacent cells in the K-map should be adjacent on the torus minor radius
     // - The wrapping should follow Gray code order
     
+    // Rows hold the leading variables, columns the trailing ones
+    int numColVars = variables.size() / 2;
+    int numRowVars = variables.size() - numColVars;
+    
     int cellSize = 128;  // Increased from 64 for better label visibility
     int gridWidth = 4;
     
@@ -581,9 +608,9 @@ void KMapGUI::updateTorusView(const std::vector<std::vector<bool>>& kmap, const
             int y = texRow * cellSize;
             
             QColor cellColor;
-            if (kmap[i][j]) {
-                // Cell is 1 - use the same color logic as table view
-                cellColor = getCellColor(i, j, groups);
+            if (kmap.get(i, j) || kmap.isDontCare(i, j)) {
+                // Cell is 1 or X - use the same color logic as table view
+                cellColor = getCellColor(kmap.getMinterm(i, j), groups);
                 
                 // Make it brighter for torus visibility
                 if (cellColor.lightness() > 200) {
@@ -603,7 +630,7 @@ void KMapGUI::updateTorusView(const std::vector<std::vector<bool>>& kmap, const
             painter.setFont(QFont("Arial", cellSize / 4, QFont::Bold));
             painter.drawText(QRect(x, y, cellSize, cellSize * 2/3), 
                              Qt::AlignCenter, 
-                             kmap[i][j] ? "1" : "0");
+                             kmap.get(i, j) ? "1" : kmap.isDontCare(i, j) ? "X" : "0");
             
             // Draw a thin border for better visibility
             painter.setPen(QPen(QColor(100, 100, 100), 2));
@@ -619,14 +646,12 @@ void KMapGUI::updateTorusView(const std::vector<std::vector<bool>>& kmap, const
             int gray_j = texCol ^ (texCol >> 1);
             
             // Row variables (top of cell)
-            int numRowVars = (variables.size() > 1) ? 2 : 1;
             QString rowBinaryStr = "";
             for (int bit = numRowVars - 1; bit >= 0; bit--) {
                 rowBinaryStr += (gray_i & (1 << bit)) ? "1" : "0";
             }
             
             // Column variables (bottom of cell)
-            int numColVars = (variables.size() > 2) ? (variables.size() - 2) : 1;
             QString colBinaryStr = "";
             for (int bit = numColVars - 1; bit >= 0; bit--) {
                 colBinaryStr += (gray_j & (1 << bit)) ? "1" : "0";
@@ -711,10 +736,8 @@ void KMapGUI::updateTorusView(const std::vector<std::vector<bool>>& kmap, const
     
     // Add variable labels
     QLabel* varLabel = new QLabel(QString("Variables: Row=%1, Col=%2")
-                                 .arg(QString::fromStdString(std::string(1, variables[0]) + 
-                                                            (variables.size() > 1 ? std::string(1, variables[1]) : "")))
-                                 .arg(QString::fromStdString(std::string(1, variables[variables.size() > 2 ? 2 : 0]) + 
-                                                            (variables.size() > 3 ? std::string(1, variables[3]) : ""))));
+                                 .arg(QString::fromStdString(std::string(variables.begin(), variables.begin() + numRowVars)))
+                                 .arg(QString::fromStdString(std::string(variables.begin() + numRowVars, variables.end()))));
     varLabel->setAlignment(Qt::AlignCenter);
     torusLayout->addWidget(varLabel);
     
@@ -741,9 +764,9 @@ void KMapGUI::updateTorusView(const std::vector<std::vector<bool>>& kmap, const
         for (size_t i = 0; i < groups.size(); ++i) {
             QLabel* colorBox = new QLabel();
             colorBox->setFixedSize(20, 20);
-            colorBox->setStyleSheet(QString("background-color: %1").arg(QColor(getCellColor(groups[i].cells[0].first, groups[i].cells[0].second, groups)).name()));
+            colorBox->setStyleSheet(QString("background-color: %1").arg(QColor(getCellColor(groups[i].cube.value, groups)).name()));
             
-            QLabel* termLabel = new QLabel(QString::fromStdString(groups[i].term));
+            QLabel* termLabel = new QLabel(QString::fromStdString(solver->getTerm(groups[i].cube)));
             
             legendLayout->addWidget(colorBox, i+1, 0);
             legendLayout->addWidget(termLabel, i+1, 1);
@@ -94,11 +94,11 @@ private:
     void clearResults();
     
     // Table view methods
-    void updateKMapTable(const std::vector<std::vector<bool>>& kmap, const std::vector<char>& variables);
-    QColor getCellColor(int row, int col, const std::vector<KMapGroup>& groups);
+    void updateKMapTable(const SolveResult& result);
+    QColor getCellColor(uint64_t minterm, const std::vector<KMapCubeGroup>& groups);
     
     // Torus view methods
-    void updateTorusView(const std::vector<std::vector<bool>>& kmap, const std::vector<char>& variables);
+    void updateTorusView(const SolveResult& result);
 };
 
 #endif // KMAP_GUI_HPP 
\ No newline at end of file
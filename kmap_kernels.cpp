@@ -0,0 +1,104 @@
+#include "kmap_kernels.hpp"
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr int pow3(int n) { return n == 0 ? 1 : 3 * pow3(n - 1); }
+
+constexpr uint64_t kLowPatterns[6] = {
+    0xAAAAAAAAAAAAAAAAull,
+    0xCCCCCCCCCCCCCCCCull,
+    0xF0F0F0F0F0F0F0F0ull,
+    0xFF00FF00FF00FF00ull,
+    0xFFFF0000FFFF0000ull,
+    0xFFFFFFFF00000000ull
+};
+
+// Every group of an N-variable K-map, including the groups that wrap across
+// the mirror lines of the Gray code from 5 variables on, is a subcube, so the
+// table lists all 3^N of them. Ternary digit k of a group index is 0 or 1 when
+// minterm bit k is fixed to that value and 2 when the bit is free.
+template <int N>
+struct KMapGroupTable {
+    static constexpr int kCount = pow3(N);
+    static constexpr int kWords = N <= 6 ? 1 : 1 << (N - 6);
+
+    Cube cubes[kCount];
+    uint64_t cells[kCount][kWords]; // minterms of the group
+    uint16_t parents[kCount][N];    // the group with bit k freed, or kCount if it is free
+
+    constexpr KMapGroupTable() : cubes(), cells(), parents() {
+        for (int g = 0; g < kCount; g++) {
+            uint64_t mask = 0, value = 0;
+            for (int k = 0, rest = g, step = 1; k < N; k++, rest /= 3, step *= 3) {
+                int digit = rest % 3;
+                parents[g][k] = static_cast<uint16_t>(digit == 2 ? kCount : g + (2 - digit) * step);
+                if (digit == 2) continue;
+                mask |= uint64_t(1) << k;
+                value |= uint64_t(digit) << k;
+            }
+            cubes[g] = Cube{mask, value};
+            for (int w = 0; w < kWords; w++) {
+                uint64_t word = N >= 6 ? ~uint64_t(0) : (uint64_t(1) << (1 << N)) - 1;
+                for (int k = 0; k < N; k++) {
+                    if (!((mask >> k) & 1)) continue;
+                    uint64_t pattern = k < 6 ? kLowPatterns[k] : (((w >> (k - 6)) & 1) ? ~uint64_t(0) : 0);
+                    word &= ((value >> k) & 1) ? pattern : ~pattern;
+                }
+                cells[g][w] = word;
+            }
+        }
+    }
+};
+
+template <int N>
+constexpr KMapGroupTable<N> kGroupTable{};
+
+// A group is an implicant when none of its cells is a 0, and prime when no
+// group with one more free variable is an implicant. Both passes have fixed trip
+// counts and no data-dependent branches in their inner loops.
+template <int N>
+void findPrimes(const uint64_t* words, CubeList& primes) {
+    using Table = KMapGroupTable<N>;
+    const Table& table = kGroupTable<N>;
+
+    // Slot kCount stands for "no parent" and is never an implicant
+    bool implicant[Table::kCount + 1];
+    for (int g = 0; g < Table::kCount; g++) {
+        uint64_t outside = 0;
+        for (int w = 0; w < Table::kWords; w++) outside |= table.cells[g][w] & ~words[w];
+        implicant[g] = outside == 0;
+    }
+    implicant[Table::kCount] = false;
+
+    for (int g = 0; g < Table::kCount; g++) {
+        bool grows = false;
+        for (int k = 0; k < N; k++) grows |= implicant[table.parents[g][k]];
+        if (implicant[g] && !grows) primes.push_back(table.cubes[g]);
+    }
+}
+
+} // namespace
+
+void findKMapPrimes(const TruthTable& onSet, CubeList& primes) {
+    const uint64_t* words = onSet.words().data();
+    switch (onSet.getVariableCount()) {
+        case 7: findPrimes<7>(words, primes); break;
+        case 8: findPrimes<8>(words, primes); break;
+        default: findKMapPrimes(words[0], onSet.getVariableCount(), primes); break;
+    }
+}
+
+void findKMapPrimes(uint64_t onSet, int varCount, CubeList& primes) {
+    switch (varCount) {
+        case 2: findPrimes<2>(&onSet, primes); break;
+        case 3: findPrimes<3>(&onSet, primes); break;
+        case 4: findPrimes<4>(&onSet, primes); break;
+        case 5: findPrimes<5>(&onSet, primes); break;
+        case 6: findPrimes<6>(&onSet, primes); break;
+        default:
+            throw std::runtime_error("The K-map kernels support 2 to " + std::to_string(kMaxKMapKernelVariables) +
+                                     " variables");
+    }
+}
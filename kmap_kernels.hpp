@@ -0,0 +1,19 @@
+#ifndef KMAP_KERNELS_HPP
+#define KMAP_KERNELS_HPP
+
+#include "truth_table.hpp"
+#include "cube_arena.hpp"
+
+// Largest variable count with compile-time K-map group tables
+const int kMaxKMapKernelVariables = 8;
+
+// Append every prime implicant of a 2 to kMaxKMapKernelVariables variable
+// function to `primes`. Each variable count has its own kernel over a constexpr
+// table of all groups of the map, picked at runtime by the variable count.
+void findKMapPrimes(const TruthTable& onSet, CubeList& primes);
+
+// The same for a 2 to kMaxWordVariables variable function given as its truth
+// table word, so callers need no TruthTable
+void findKMapPrimes(uint64_t onSet, int varCount, CubeList& primes);
+
+#endif // KMAP_KERNELS_HPP
@@ -1,4 +1,14 @@
 #include "kmap_solver.hpp"
+#include "quine_mccluskey.hpp"
+#include "espresso.hpp"
+#include "bdd.hpp"
+#include "kmap_kernels.hpp"
+#include "cover_table.hpp"
+#include "npn_cache.hpp"
+#include "solution_cache.hpp"
+#include "cube_arena.hpp"
+#include "cover_solver.hpp"
+#include "task_scheduler.hpp"
 #include <iostream>
 #include <algorithm>
 #include <sstream>
@@ -7,7 +17,9 @@
 #include <set>
 #include <map>
 #include <utility>
+#include <iterator>
 #include <bitset>
+#include <exception>
 
 using std::cout;
 using std::cerr;
@@ -20,35 +32,131 @@ using std::map;
 
 KMapSolver::KMapSolver(const string& equation) : equation(equation) {
     parseEquation();
+    compileEquation();
 }
 
 KMapSolver::KMapSolver(const string& equation, int expectedVariableCount) : equation(equation) {
     parseEquation(expectedVariableCount);
+    compileEquation();
 }
 
 KMapSolver::KMapSolver(const string& equation, const vector<char>& expectedVariables) : equation(equation) {
     parseEquation(expectedVariables);
+    compileEquation();
 }
 
-void KMapSolver::parseEquation() {
-    // Extract unique variables from the equation
-    variables.clear();
-    for (char c : equation) {
-        if (isalpha(c) && std::find(variables.begin(), variables.end(), c) == variables.end()) {
-            variables.push_back(c);
+// Helper: a truth table copied from a caller's word buffer
+static TruthTable loadTable(const uint64_t* words, int varCount) {
+    TruthTable table(varCount);
+    for (size_t w = 0; w < table.wordCount(); w++) table.words()[w] = words[w] & table.wordMask();
+    return table;
+}
+
+KMapSolver::KMapSolver(const uint64_t* onSet, int varCount, const uint64_t* dontCares) {
+    if (varCount < 2 || varCount > kMaxTruthTableVariables) {
+        throw std::runtime_error("Only 2 to " + std::to_string(kMaxTruthTableVariables) + " variables are supported");
+    }
+    for (int i = 0; i < varCount; i++) variables.push_back('A' + i);
+    loadedOnSet = loadTable(onSet, varCount);
+    if (dontCares) loadedDontCares = loadTable(dontCares, varCount);
+    compileEquation();
+}
+
+// Terms of an equation other than products
+enum class TermKind { Product, Minterms, DontCares, HexTable };
+
+// Helper: the kind of a '+' separated term; `body` gets the term without spaces,
+// or just the index list or hex digits
+static TermKind classifyTerm(const string& term, string& body) {
+    body = term;
+    body.erase(std::remove(body.begin(), body.end(), ' '), body.end());
+    if (body.size() >= 3 && (body[0] == 'm' || body[0] == 'd') && body[1] == '(' && body.back() == ')') {
+        TermKind kind = body[0] == 'm' ? TermKind::Minterms : TermKind::DontCares;
+        body = body.substr(2, body.size() - 3);
+        return kind;
+    }
+    if (body.size() > 2 && body[0] == '0' && (body[1] == 'x' || body[1] == 'X')) {
+        body = body.substr(2);
+        if (body.find_first_not_of("0123456789abcdefABCDEF") != string::npos) {
+            throw std::runtime_error("Invalid hex truth table 0x" + body);
         }
+        return TermKind::HexTable;
     }
-    std::sort(variables.begin(), variables.end());
+    return TermKind::Product;
 }
 
-void KMapSolver::parseEquation(int expectedVariableCount) {
-    // Extract unique variables from the equation first
-    set<char> foundVars;
-    for (char c : equation) {
-        if (isalpha(c)) {
-            foundVars.insert(c);
+// Helper: the indices of a minterm or don't-care list such as "1,3,5"
+static vector<uint64_t> parseIndexList(const string& body) {
+    vector<uint64_t> indices;
+    stringstream ss(body);
+    string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty() || item.size() > 9 || item.find_first_not_of("0123456789") != string::npos) {
+            throw std::runtime_error("Invalid minterm index \"" + item + "\"");
         }
+        indices.push_back(std::stoull(item));
     }
+    return indices;
+}
+
+// Helper: the letters of the product terms. `indexedCount` gets the fewest
+// variables that index every list and table (-1 when there are none).
+static set<char> productLetters(const string& equation, int& indexedCount) {
+    set<char> letters;
+    indexedCount = -1;
+    stringstream ss(equation);
+    string term, body;
+    while (std::getline(ss, term, '+')) {
+        TermKind kind = classifyTerm(term, body);
+        if (kind == TermKind::Product) {
+            for (char c : body) {
+                if (isalpha(c)) letters.insert(c);
+            }
+            continue;
+        }
+        int count = 0;
+        if (kind == TermKind::HexTable) {
+            // Four minterms per digit
+            while ((uint64_t(1) << count) < 4 * body.size()) count++;
+        } else {
+            for (uint64_t index : parseIndexList(body)) {
+                while (index >> count) count++;
+            }
+        }
+        indexedCount = std::max(indexedCount, count);
+    }
+    return letters;
+}
+
+void KMapSolver::parseEquation() {
+    // Extract unique variables from the product terms
+    int indexedCount;
+    set<char> letters = productLetters(equation, indexedCount);
+    variables.assign(letters.begin(), letters.end());
+    if (indexedCount < 0) return;
+    
+    // Minterm lists and truth tables number the variables A, B, C, ... from
+    // the most significant minterm bit
+    int count = std::max(2, indexedCount);
+    for (char var : letters) {
+        if (var < 'A' || var > 'Z') {
+            throw std::runtime_error("Variable " + string(1, var) +
+                                     " cannot be combined with minterm lists or truth tables (use A-Z)");
+        }
+        count = std::max(count, var - 'A' + 1);
+    }
+    if (count > kMaxTruthTableVariables) {
+        throw std::runtime_error("Minterm lists and truth tables support up to " +
+                                 std::to_string(kMaxTruthTableVariables) + " variables");
+    }
+    variables.clear();
+    for (int i = 0; i < count; i++) variables.push_back('A' + i);
+}
+
+void KMapSolver::parseEquation(int expectedVariableCount) {
+    // Extract unique variables from the product terms first
+    int indexedCount;
+    set<char> foundVars = productLetters(equation, indexedCount);
     
     // Build the variable list with expected count, starting from 'A'
     variables.clear();
@@ -67,13 +175,9 @@ void KMapSolver::parseEquation(int expectedVariableCount) {
 }
 
 void KMapSolver::parseEquation(const vector<char>& expectedVariables) {
-    // Extract unique variables from the equation first
-    set<char> foundVars;
-    for (char c : equation) {
-        if (isalpha(c)) {
-            foundVars.insert(c);
-        }
-    }
+    // Extract unique variables from the product terms first
+    int indexedCount;
+    set<char> foundVars = productLetters(equation, indexedCount);
     
     // Use the provided variable list
     variables = expectedVariables;
@@ -87,13 +191,29 @@ void KMapSolver::parseEquation(const vector<char>& expectedVariables) {
     }
 }
 
+void KMapSolver::solve(KMap& kmap) const {
+    int varCount = variables.size();
+    if (varCount < 2 || varCount > kMaxTruthTableVariables) {
+        throw std::runtime_error("Only 2 to " + std::to_string(kMaxTruthTableVariables) + " variables are supported");
+    }
+    kmap = getResult()->kmap;
+}
+
 vector<vector<bool>> KMapSolver::solve() const {
-    return const_cast<KMapSolver*>(this)->generateKMap();
+    KMap kmap;
+    solve(kmap);
+    return kmap.toGrid();
 }
 
 string KMapSolver::getMinimizedExpression() const {
-    // Use real minimization logic for up to 4 variables
-    return minimizeExpression();
+    bool provenOptimal;
+    return getMinimizedExpression(provenOptimal);
+}
+
+string KMapSolver::getMinimizedExpression(bool& provenOptimal) const {
+    std::shared_ptr<const SolveResult> solved = getResult();
+    provenOptimal = solved->provenOptimal;
+    return solved->expression;
 }
 
 vector<string> KMapSolver::findGroups(const vector<vector<bool>>& kmap) const {
@@ -129,6 +249,149 @@ string KMapSolver::combineTerms(const vector<string>& groups) const {
     return result;
 }
 
+void KMapSolver::setEvaluationMode(EvaluationMode mode) {
+    evaluationMode = mode;
+    resetSnapshot();
+}
+
+EvaluationMode KMapSolver::getEvaluationMode() const {
+    return evaluationMode;
+}
+
+void KMapSolver::setThreadCount(int count) {
+    if (count < 0) {
+        throw std::runtime_error("Thread count must not be negative");
+    }
+    threadCount = count;
+    resetSnapshot();
+}
+
+int KMapSolver::getThreadCount() const {
+    return threadCount;
+}
+
+void KMapSolver::setEngine(MinimizerEngine engine) {
+    this->engine = engine;
+    resetSnapshot();
+}
+
+MinimizerEngine KMapSolver::getEngine() const {
+    return engine;
+}
+
+ImplicitPrimeStats KMapSolver::getPrimeStats() const {
+    return getResult()->primeStats;
+}
+
+std::shared_ptr<const SolveResult> KMapSolver::getResult() const {
+    std::lock_guard<std::mutex> lock(resultMutex);
+    if (!snapshot) {
+        snapshot = computeResult();
+        previous.reset();
+        previousCubes.clear();
+    }
+    return snapshot;
+}
+
+DualFormResult KMapSolver::getDualForm() const {
+    int varCount = variables.size();
+    if (varCount < 2 || varCount > kMaxTruthTableVariables) {
+        throw std::runtime_error("Only 2 to " + std::to_string(kMaxTruthTableVariables) + " variables are supported");
+    }
+    DualFormResult dual;
+    std::lock_guard<std::mutex> lock(resultMutex);
+    TruthTable table, free;
+    bool repair = false;
+    if (snapshot) {
+        table = snapshot->kmap.getTable();
+        free = snapshot->kmap.getDontCares();
+    } else {
+        repair = buildFunction(table, free);
+    }
+    TruthTable offSet(varCount);
+    for (size_t w = 0; w < offSet.wordCount(); w++) {
+        uint64_t taken = table.words()[w] | (free.getVariableCount() > 0 ? free.words()[w] : 0);
+        offSet.words()[w] = ~taken & offSet.wordMask();
+    }
+    
+    // Worker threads cannot throw across runTasks, so failures are handed back
+    std::exception_ptr failures[2];
+    runTasks(snapshot ? 1 : 2, 2, [&](size_t task) {
+        try {
+            if (task == 0 && !snapshot) {
+                dual.sop = solveFunction(table, free, onSetCubes(), repair);
+            } else {
+                dual.offSet = solveFunction(offSet, free, tableToCubes(offSet), false);
+            }
+        } catch (...) {
+            failures[task] = std::current_exception();
+        }
+    });
+    for (const std::exception_ptr& failure : failures) {
+        if (failure) std::rethrow_exception(failure);
+    }
+    if (snapshot) {
+        dual.sop = snapshot;
+    } else {
+        snapshot = dual.sop;
+        previous.reset();
+        previousCubes.clear();
+    }
+    
+    // Each cube of the off-set cover is one sum, with its literals complemented
+    const vector<Cube>& sums = dual.offSet->cover;
+    string& expression = dual.posExpression;
+    if (sums.empty()) {
+        expression = "1";
+    } else if (std::any_of(sums.begin(), sums.end(), [](const Cube& cube) { return cube.mask == 0; })) {
+        expression = "0";
+    } else {
+        for (const Cube& cube : sums) {
+            bool parenthesized = __builtin_popcountll(cube.mask) > 1;
+            if (parenthesized) expression += '(';
+            bool first = true;
+            for (int k = 0; k < varCount; k++) {
+                uint64_t bit = uint64_t(1) << (varCount - 1 - k);
+                if (!(cube.mask & bit)) continue;
+                if (!first) expression += " + ";
+                expression += variables[k];
+                if (cube.value & bit) expression += '\'';
+                first = false;
+            }
+            if (parenthesized) expression += ')';
+        }
+    }
+    dual.posCheaper = std::make_pair(sums.size(), dual.offSet->literalCount) <
+                      std::make_pair(dual.sop->cover.size(), dual.sop->literalCount);
+    return dual;
+}
+
+void KMapSolver::resetSnapshot() {
+    std::lock_guard<std::mutex> lock(resultMutex);
+    snapshot.reset();
+    // A new configuration solves from scratch
+    previous.reset();
+    previousCubes.clear();
+}
+
+MinimizerEngine KMapSolver::resolveEngine() const {
+    if (engine != MinimizerEngine::Auto) return engine;
+    int varCount = variables.size();
+    if (varCount <= kMaxKMapKernelVariables) return MinimizerEngine::KMap;
+    if (varCount <= 16) return MinimizerEngine::QuineMcCluskey;
+    return MinimizerEngine::Espresso;
+}
+
+MinimizerEngine parseMinimizerEngine(const string& name) {
+    if (name == "auto") return MinimizerEngine::Auto;
+    if (name == "kmap") return MinimizerEngine::KMap;
+    if (name == "qm") return MinimizerEngine::QuineMcCluskey;
+    if (name == "espresso") return MinimizerEngine::Espresso;
+    if (name == "bdd") return MinimizerEngine::Bdd;
+    if (name == "zdd") return MinimizerEngine::Zdd;
+    throw std::runtime_error("Unknown engine " + name + " (expected auto, kmap, qm, espresso, bdd or zdd)");
+}
+
 int KMapSolver::getVariableCount() const {
     return variables.size();
 }
@@ -137,239 +400,469 @@ vector<char> KMapSolver::getVariables() const {
     return variables;
 }
 
-bool KMapSolver::evaluateExpression(const string& expr) {
-    // Split the expression into terms (separated by +)
-    stringstream ss(expr);
-    string term;
-    bool result = false;
+// Helper: set the minterms of a hex truth table; the last digit holds minterms 0-3
+static void loadHexTable(const string& digits, TruthTable& table) {
+    for (size_t i = 0; i < digits.size(); i++) {
+        char c = digits[digits.size() - 1 - i];
+        int nibble = isdigit(c) ? c - '0' : tolower(c) - 'a' + 10;
+        for (int bit = 0; bit < 4; bit++) {
+            if (!((nibble >> bit) & 1)) continue;
+            uint64_t minterm = 4 * i + bit;
+            if (minterm >= table.size()) {
+                throw std::runtime_error("Truth table 0x" + digits + " has more than " +
+                                         std::to_string(table.size()) + " minterms");
+            }
+            table.set(minterm);
+        }
+    }
+}
+
+void KMapSolver::compileEquation() {
+    // Compiled aside, so a bad edit leaves the current products in place
+    vector<Literal> literals;
+    vector<uint32_t> productEnds;
+    int varCount = variables.size();
+    TruthTable listed = loadedOnSet, listedDontCares = loadedDontCares;
     
-    while (std::getline(ss, term, '+')) {
-        // Remove spaces
-        term.erase(std::remove(term.begin(), term.end(), ' '), term.end());
+    // Split the expression into terms (separated by +), exactly once
+    stringstream ss(equation);
+    string piece, term;
+    while (std::getline(ss, piece, '+')) {
+        // Minterm lists and truth tables load straight into their tables
+        TermKind kind = classifyTerm(piece, term);
+        if (kind != TermKind::Product) {
+            if (varCount < 2 || varCount > kMaxTruthTableVariables) {
+                throw std::runtime_error("Minterm lists and truth tables need 2 to " +
+                                         std::to_string(kMaxTruthTableVariables) + " variables");
+            }
+            TruthTable& target = kind == TermKind::DontCares ? listedDontCares : listed;
+            if (target.getVariableCount() == 0) target = TruthTable(varCount);
+            if (kind == TermKind::HexTable) {
+                loadHexTable(term, target);
+                continue;
+            }
+            for (uint64_t minterm : parseIndexList(term)) {
+                if (minterm >= target.size()) {
+                    throw std::runtime_error("Minterm " + std::to_string(minterm) + " is out of range for " +
+                                             std::to_string(varCount) + " variables");
+                }
+                target.set(minterm);
+            }
+            continue;
+        }
         
-        // Evaluate each term
-        bool termResult = true;
         for (size_t i = 0; i < term.length(); i++) {
             if (isalpha(term[i])) {
-                // Check if this variable exists in our variable map
-                if (variableValues.find(term[i]) == variableValues.end()) {
+                auto it = std::find(variables.begin(), variables.end(), term[i]);
+                if (it == variables.end()) {
                     throw std::runtime_error("Variable " + string(1, term[i]) + " not found in variable mapping");
                 }
                 
-                bool value = variableValues[term[i]];
+                Literal lit;
+                lit.var = static_cast<uint8_t>(it - variables.begin());
+                lit.negated = false;
                 // Check for NOT operator
                 if (i + 1 < term.length() && term[i + 1] == '\'') {
-                    value = !value;
+                    lit.negated = true;
                     i++; // Skip the ' character
                 }
-                termResult &= value;
+                literals.push_back(lit);
             }
         }
-        result |= termResult;
+        productEnds.push_back(literals.size());
     }
     
-    return result;
+    cubes = productsToCubes(literals, productEnds, variables.size());
+    this->literals.swap(literals);
+    this->productEnds.swap(productEnds);
+    listedOnSet = std::move(listed);
+    dontCares = std::move(listedDontCares);
 }
 
-vector<vector<bool>> KMapSolver::generateKMap() {
-    int varCount = variables.size();
-    
-    // Determine dimensions based on number of variables
-    int rows, cols;
-    if (varCount == 2) {
-        rows = 2;
-        cols = 2;
-    } else if (varCount == 3) {
-        rows = 4;
-        cols = 2;
-    } else if (varCount == 4) {
-        rows = 4;
-        cols = 4;
-    } else {
-        throw std::runtime_error("Only 2, 3, or 4 variables are supported");
+void KMapSolver::setEquation(const string& equation) {
+    string current = this->equation;
+    this->equation = equation;
+    vector<Cube> before = cubes;
+    TruthTable listedBefore = listedOnSet, dontCaresBefore = dontCares;
+    try {
+        compileEquation();
+    } catch (...) {
+        this->equation = current;
+        throw;
     }
     
-    vector<vector<bool>> kmap(rows, vector<bool>(cols, false));
+    // Pending edits accumulate against the last snapshot that was solved;
+    // only product edits are patched in, other changes solve from scratch
+    std::lock_guard<std::mutex> lock(resultMutex);
+    if (snapshot) {
+        previous = snapshot;
+        previousCubes.swap(before);
+    }
+    if (listedOnSet != listedBefore || dontCares != dontCaresBefore) {
+        previous.reset();
+        previousCubes.clear();
+    }
+    snapshot.reset();
+}
+
+void KMapSolver::addTerm(const string& term) {
+    setEquation(equation.empty() ? term : equation + " + " + term);
+}
+
+void KMapSolver::removeTerm(const string& term) {
+    // Terms are compared compiled, so literal order and spacing do not matter
+    KMapSolver target(term, variables);
+    auto matches = [&](const string& piece) {
+        KMapSolver parsed(piece, variables);
+        return parsed.cubes == target.cubes && parsed.listedOnSet == target.listedOnSet &&
+               parsed.dontCares == target.dontCares;
+    };
     
-    // Generate all possible combinations using Gray code
-    for (int i = 0; i < rows; i++) {
-        for (int j = 0; j < cols; j++) {
-            // Convert to Gray code
-            int gray_i = i ^ (i >> 1);  // Convert row index to Gray code
-            int gray_j = j ^ (j >> 1);  // Convert column index to Gray code
-            
-            // Set variable values based on Gray code
-            if (varCount == 2) {
-                // For 2 variables: first variable is bit 1 of row, second variable is bit 0 of row
-                // Gray code mapping: 00->00, 01->01, 10->11, 11->10
-                variableValues[variables[0]] = (gray_i & 1) != 0;  // LSB of row Gray code
-                variableValues[variables[1]] = (gray_j & 1) != 0;  // LSB of column Gray code
-            } else if (varCount == 3) {
-                // For 3 variables: first two in rows, third in columns
-                variableValues[variables[0]] = (gray_i & 2) != 0;
-                variableValues[variables[1]] = (gray_i & 1) != 0;
-                variableValues[variables[2]] = (gray_j & 1) != 0;
-            } else if (varCount == 4) {
-                // For 4 variables: first two in rows, last two in columns
-                variableValues[variables[0]] = (gray_i & 2) != 0;
-                variableValues[variables[1]] = (gray_i & 1) != 0;
-                variableValues[variables[2]] = (gray_j & 2) != 0;
-                variableValues[variables[3]] = (gray_j & 1) != 0;
-            }
-            
-            kmap[i][j] = evaluateExpression(equation);
+    vector<string> products;
+    stringstream ss(equation);
+    string product;
+    while (std::getline(ss, product, '+')) products.push_back(product);
+    for (size_t p = 0; p < products.size(); p++) {
+        if (!matches(products[p])) continue;
+        string edited;
+        for (size_t q = 0, kept = 0; q < products.size(); q++) {
+            if (q == p) continue;
+            if (kept++ > 0) edited += "+";
+            edited += products[q];
         }
+        setEquation(edited);
+        return;
     }
-    
-    return kmap;
+    throw std::runtime_error("Term " + term + " is not in the equation");
 }
 
-// Helper function to get variable term for a group
-static string getGroupTerm(const vector<char>& variables, int rowMask, int colMask, int rowVal, int colVal, int varCount) {
-    string term;
-    
-    // This function is called with cells already identified as belonging to the same group
-    // We need to look at the actual coordinates to determine which variables are constant
-    
-    if (varCount == 2) {
-        // 2 variables: first variable in rows, second variable in columns
-        // rowMask == 0 means first variable is constant (include it)
-        // colMask == 0 means second variable is constant (include it)
-        if (rowMask == 0) { // First variable is constant
-            term += variables[0];
-            if ((rowVal & 1) == 0) term += "'"; // Complement if value is 0
-        }
-        if (colMask == 0) { // Second variable is constant  
-            term += variables[1];
-            if ((colVal & 1) == 0) term += "'"; // Complement if value is 0
-        }
-    } else if (varCount == 3) {
-        // 3 variables: first two in rows, third in column
-        if (!(rowMask & (1 << 1))) { // First variable (constant)
-            term += variables[0];
-            if (!((rowVal >> 1) & 1)) term += "'";
-        }
-        if (!(rowMask & (1 << 0))) { // Second variable (constant)
-            term += variables[1];
-            if (!((rowVal >> 0) & 1)) term += "'";
-        }
-        if (!(colMask & (1 << 0))) { // Third variable (constant)
-            term += variables[2];
-            if (!((colVal >> 0) & 1)) term += "'";
-        }
-    } else if (varCount == 4) {
-        // This is a placeholder - the real logic will be done by analyzing cells
-        // For now, return empty string to signal we need cell-based analysis
-        return "";
-    }
-    return term;
-}
-
-// Helper function specifically for 4-variable term generation using cell coordinates
-static string getGroupTermFromCells(const vector<char>& variables, const vector<std::pair<int,int>>& cells) {
-    if (variables.size() != 4) return "";
-    
-    // Get the Gray code values for all cells in the group
-    set<int> rowGrays, colGrays;
-    for (const auto& cell : cells) {
-        int r = cell.first, c = cell.second;
-        int gray_r = r ^ (r >> 1);
-        int gray_c = c ^ (c >> 1);
-        rowGrays.insert(gray_r);
-        colGrays.insert(gray_c);
+const string& KMapSolver::getEquation() const {
+    return equation;
+}
+
+TruthTable KMapSolver::buildTruthTable() const {
+    TruthTable table(variables.size());
+    // Each block owns disjoint words of the table, so the result is identical
+    // to a single-threaded pass
+    forEachWordBlock(table.wordCount(), threadCount, [&](size_t begin, size_t end) {
+        switch (evaluationMode) {
+            case EvaluationMode::Auto:
+            case EvaluationMode::CubeRaster:
+                // Compiled equations are always plain sums of products
+                rasterizeCubes(cubes, table, begin, end);
+                break;
+            case EvaluationMode::BitSliced:
+                evaluateBitSliced(literals, productEnds, table, begin, end);
+                break;
+            case EvaluationMode::GrayIncremental:
+                evaluateGrayIncremental(literals, productEnds, table, begin, end);
+                break;
+        }
+        // Minterms listed by m(...) or a hex table
+        if (listedOnSet.getVariableCount() > 0) {
+            for (size_t w = begin; w < end; w++) table.words()[w] |= listedOnSet.words()[w];
+        }
+    });
+    return table;
+}
+
+vector<Cube> KMapSolver::onSetCubes() const {
+    vector<Cube> onSet = cubes;
+    if (listedOnSet.getVariableCount() > 0) {
+        vector<Cube> listed = tableToCubes(listedOnSet);
+        onSet.insert(onSet.end(), listed.begin(), listed.end());
     }
+    return onSet;
+}
+
+// Longest term: every variable negated
+static const size_t kMaxTermLength = 2 * 64;
+
+// Helper: write the literals of a cube into `out` ("1" when every variable is
+// eliminated) and return their length
+static size_t formatTerm(const vector<char>& variables, const Cube& cube, char* out) {
+    int varCount = variables.size();
+    size_t length = 0;
+    for (int k = 0; k < varCount; k++) {
+        uint64_t bit = uint64_t(1) << (varCount - 1 - k);
+        if (cube.mask & bit) {
+            out[length++] = variables[k];
+            if (!(cube.value & bit)) out[length++] = '\'';
+        }
+    }
+    if (length == 0) out[length++] = '1';
+    return length;
+}
+
+// Helper: order cubes the way their printed terms sort
+static bool termLess(const vector<char>& variables, const Cube& a, const Cube& b) {
+    char termA[kMaxTermLength], termB[kMaxTermLength];
+    size_t lengthA = formatTerm(variables, a, termA), lengthB = formatTerm(variables, b, termB);
+    return std::lexicographical_compare(termA, termA + lengthA, termB, termB + lengthB);
+}
+
+// Helper: sort a cover the way its printed terms sort
+static void sortByTerm(const vector<char>& variables, CubeList& cover) {
+    std::sort(cover.begin(), cover.end(), [&](const Cube& a, const Cube& b) { return termLess(variables, a, b); });
+}
+
+// Helper: the table before an edit updated to the current products. Added terms
+// are ORed in; the minterms of removed terms are cleared and refilled from the
+// current products that overlap them and the listed minterms.
+static TruthTable editTruthTable(const TruthTable& before, vector<Cube> beforeCubes, const vector<Cube>& current,
+                                 const TruthTable& listed) {
+    vector<Cube> cubes(current);
+    std::sort(beforeCubes.begin(), beforeCubes.end());
+    std::sort(cubes.begin(), cubes.end());
+    vector<Cube> removed, refill;
+    std::set_difference(beforeCubes.begin(), beforeCubes.end(), cubes.begin(), cubes.end(), std::back_inserter(removed));
+    std::set_difference(cubes.begin(), cubes.end(), beforeCubes.begin(), beforeCubes.end(), std::back_inserter(refill));
     
-    string term;
-    
-    // Analyze row variables (A, B)
-    if (rowGrays.size() == 1) {
-        // Both A and B are constant
-        int grayVal = *rowGrays.begin();
-        // A = bit 1, B = bit 0 in Gray code
-        term += variables[0]; // A
-        if ((grayVal & 2) == 0) term += "'"; // A is 0
-        term += variables[1]; // B  
-        if ((grayVal & 1) == 0) term += "'"; // B is 0
-    } else if (rowGrays.size() == 2) {
-        // One of A or B is constant
-        vector<int> grays(rowGrays.begin(), rowGrays.end());
-        int diff = grays[0] ^ grays[1];
-        if (diff == 1) {
-            // Only B varies (bit 0), A is constant (bit 1)
-            int aVal = grays[0] & 2; // A's value from bit 1
-            term += variables[0]; // A
-            if (aVal == 0) term += "'";
-        } else if (diff == 2) {
-            // Only A varies (bit 1), B is constant (bit 0)
-            int bVal = grays[0] & 1; // B's value from bit 0
-            term += variables[1]; // B
-            if (bVal == 0) term += "'";
-        }
-        // If diff == 3, both A and B vary, so neither is included
-    }
-    // If rowGrays.size() > 2, both A and B vary, so neither is included
+    TruthTable table = before;
+    clearCubes(removed, table);
+    for (const Cube& gone : removed) {
+        for (const Cube& cube : current) {
+            if ((gone.value ^ cube.value) & gone.mask & cube.mask) continue;
+            refill.push_back({gone.mask | cube.mask, gone.value | cube.value});
+        }
+    }
+    rasterizeCubes(refill, table);
+    if (listed.getVariableCount() > 0) {
+        for (size_t w = 0; w < table.wordCount(); w++) table.words()[w] |= listed.words()[w];
+    }
+    return table;
+}
+
+// Helper: the on-set plus don't-cares
+static TruthTable careTable(const TruthTable& onSet, const TruthTable& dontCares) {
+    TruthTable care = onSet;
+    for (size_t w = 0; w < care.wordCount(); w++) care.words()[w] |= dontCares.words()[w];
+    return care;
+}
+
+// On-set minterms sampled for the lower bound of a cover that is not proven
+static const size_t kBoundMintermLimit = 1024;
+
+size_t independentMinterms(const TruthTable& table, const TruthTable& care) {
+    uint64_t full = variableMask(table.getVariableCount());
+    uint64_t careCount = care.count();
+    uint64_t stride = std::max<uint64_t>(1, table.count() / kBoundMintermLimit);
+    vector<uint64_t> chosen;
+    uint64_t seen = 0, next = 0; // on-set minterms passed, and the rank of the next sample
+    for (size_t w = 0; w < table.wordCount(); w++) {
+        uint64_t bits = table.words()[w];
+        uint64_t ones = __builtin_popcountll(bits);
+        for (; bits && next < seen + ones; bits &= bits - 1, seen++, ones--) {
+            if (seen != next) continue;
+            next += stride;
+            uint64_t m = (uint64_t(w) << 6) | __builtin_ctzll(bits);
+            bool independent = std::all_of(chosen.begin(), chosen.end(), [&](uint64_t other) {
+                int distance = __builtin_popcountll(m ^ other);
+                // A spanning cube larger than the whole care set cannot fit in it
+                if (distance >= 64 || (uint64_t(1) << distance) > careCount) return true;
+                uint64_t mask = full & ~(m ^ other);
+                return !care.containsCube(Cube{mask, m & mask});
+            });
+            if (independent) chosen.push_back(m);
+        }
+        seen += ones;
+    }
+    return chosen.size();
+}
+
+// The single solve pass: table, engine, then everything derived from the cover
+std::shared_ptr<const SolveResult> KMapSolver::computeResult() const {
+    TruthTable table, free;
+    bool repair = buildFunction(table, free);
+    return solveFunction(table, free, onSetCubes(), repair);
+}
+
+// The function's table and its don't-cares outside the on-set, both empty
+// beyond kMaxTruthTableVariables; true when the previous result is to be repaired
+bool KMapSolver::buildFunction(TruthTable& table, TruthTable& free) const {
+    int varCount = variables.size();
+    if (varCount < 2 || varCount > kMaxTruthTableVariables) return false;
+    // After an edit the previous table is patched rather than rebuilt, and
+    // a Quine-McCluskey result with its primes is repaired
+    bool edited = static_cast<bool>(previous);
+    table = edited ? editTruthTable(previous->kmap.getTable(), previousCubes, cubes, listedOnSet) : buildTruthTable();
+    // A minterm both listed and don't-care is in the on-set
+    free = dontCares;
+    for (size_t w = 0; w < free.wordCount() && free.getVariableCount() > 0; w++) {
+        free.words()[w] &= ~table.words()[w];
+    }
+    // A cut-off result may hold implicants that are not prime, so it is solved afresh
+    return edited && resolveEngine() == MinimizerEngine::QuineMcCluskey && !previous->fromCache &&
+           !previous->budgetExpired;
+}
+
+// Minimizes the function given by `table` and `free` (the engines that need no
+// table start from the products `onSet`). Terms are only spelled out here,
+// straight into the expression.
+std::shared_ptr<SolveResult> KMapSolver::solveFunction(const TruthTable& table, const TruthTable& free,
+                                                      const vector<Cube>& onSet, bool repair) const {
+    auto solved = std::make_shared<SolveResult>();
+    int varCount = variables.size();
+    solved->variables = variables;
+    solved->engine = resolveEngine();
     
-    // Analyze column variables (C, D)
-    if (colGrays.size() == 1) {
-        // Both C and D are constant
-        int grayVal = *colGrays.begin();
-        // C = bit 1, D = bit 0 in Gray code
-        term += variables[2]; // C
-        if ((grayVal & 2) == 0) term += "'"; // C is 0
-        term += variables[3]; // D
-        if ((grayVal & 1) == 0) term += "'"; // D is 0
-    } else if (colGrays.size() == 2) {
-        // One of C or D is constant
-        vector<int> grays(colGrays.begin(), colGrays.end());
-        int diff = grays[0] ^ grays[1];
-        if (diff == 1) {
-            // Only D varies (bit 0), C is constant (bit 1)
-            int cVal = grays[0] & 2; // C's value from bit 1
-            term += variables[2]; // C
-            if (cVal == 0) term += "'";
-        } else if (diff == 2) {
-            // Only C varies (bit 1), D is constant (bit 0)
-            int dVal = grays[0] & 1; // D's value from bit 0
-            term += variables[3]; // D
-            if (dVal == 0) term += "'";
-        }
-        // If diff == 3, both C and D vary, so neither is included
-    }
-    // If colGrays.size() > 2, both C and D vary, so neither is included
+    CubeArenaScope scope;
+    CubeList cover(scope.arena);
+    SolveBudget budget(deadlineMs, stepLimit);
+    if (varCount >= 2) {
+        if (varCount <= kMaxTruthTableVariables) solved->kmap = KMap(table, free);
+        if (repair) {
+            repairCover(table, free, *solved, cover, budget);
+        } else {
+            minimalCover(table, free, onSet, *solved, cover, budget);
+        }
+        if (varCount <= kMaxTruthTableVariables) {
+            solved->essentials = findEssentialPrimes(solved->primes.data(), solved->primes.size(), table);
+            // Every cover holds the essentials, so a repaired cover of nothing else is minimal
+            if (solved->repaired) {
+                solved->lowerBound = solved->essentials.size();
+                if (solved->essentials.size() == cover.size()) solved->provenOptimal = true;
+            }
+        }
+    }
+    solved->cover.assign(cover.begin(), cover.end());
+    if (varCount >= 2 && varCount <= kMaxTruthTableVariables) {
+        // Self-check: the cover must agree with the function outside the don't-cares
+        TruthTable covered(varCount);
+        rasterizeCubes(solved->cover, covered);
+        uint64_t minterm;
+        if (firstDifference(covered, solved->kmap.getTable(), solved->kmap.getDontCares(), minterm)) {
+            throw std::runtime_error("Self-check failed: the cover differs from the equation at minterm " +
+                                     std::to_string(minterm));
+        }
+    }
+    solved->budgetExpired = budget.expired();
+    // Whatever its last stage reported, a cut-off solve has proven nothing
+    if (solved->budgetExpired) solved->provenOptimal = false;
+    for (const Cube& cube : cover) solved->literalCount += __builtin_popcountll(cube.mask);
+    if (solved->provenOptimal) {
+        solved->lowerBound = cover.size();
+    } else if (!cover.empty() && varCount <= kMaxTruthTableVariables) {
+        bool hasDontCares = free.getVariableCount() > 0;
+        solved->lowerBound = std::max(solved->lowerBound,
+                                      independentMinterms(table, hasDontCares ? careTable(table, free) : table));
+    }
     
-    // If no variables are included, this means all variables vary and the term is "1"
-    if (term.empty()) {
-        return "1";
+    bool drawable = varCount <= kMaxDisplayVariables;
+    solved->groups.reserve(cover.size());
+    for (const Cube& cube : cover) {
+        solved->groups.push_back(drawable ? solved->kmap.makeGroup(cube) : KMapCubeGroup{cube, TruthTable()});
     }
     
-    return term;
+    string& expression = solved->expression;
+    bool tautology = std::any_of(cover.begin(), cover.end(), [](const Cube& cube) { return cube.mask == 0; });
+    if (cover.empty()) {
+        expression = "0"; // No minterms to cover
+    } else if (tautology) {
+        expression = "1"; // A cube with no literals is always true
+    } else {
+        expression.reserve(cover.size() * (2 * variables.size() + 3));
+        char term[kMaxTermLength];
+        for (size_t i = 0; i < cover.size(); ++i) {
+            if (i > 0) expression += " + ";
+            expression.append(term, formatTerm(variables, cover[i], term));
+        }
+    }
+    return solved;
+}
+
+// Nodes an equivalence check may build before it falls back to truth tables,
+// when the union of the variables is narrow enough for one
+static const size_t kEquivalenceNodeLimit = size_t(1) << 22;
+
+vector<Cube> remapCubes(const vector<Cube>& cubes, const vector<char>& from, const vector<char>& to) {
+    if (from == to) return cubes;
+    int fromCount = from.size(), toCount = to.size();
+    vector<uint64_t> targetBits(fromCount);
+    for (int k = 0; k < fromCount; k++) {
+        int position = std::find(to.begin(), to.end(), from[k]) - to.begin();
+        targetBits[k] = uint64_t(1) << (toCount - 1 - position);
+    }
+    vector<Cube> mapped;
+    mapped.reserve(cubes.size());
+    for (const Cube& cube : cubes) {
+        Cube out{0, 0};
+        for (int k = 0; k < fromCount; k++) {
+            uint64_t bit = uint64_t(1) << (fromCount - 1 - k);
+            if (!(cube.mask & bit)) continue;
+            out.mask |= targetBits[k];
+            if (cube.value & bit) out.value |= targetBits[k];
+        }
+        mapped.push_back(out);
+    }
+    return mapped;
 }
 
-// Real K-map minimization for up to 4 variables
-string KMapSolver::minimizeExpression() const {
-    // Use getMinimalCoverGroups for consistency
-    std::vector<KMapGroup> groups = getMinimalCoverGroups();
+EquivalenceResult KMapSolver::equivalent(const KMapSolver& first, const KMapSolver& second) {
+    EquivalenceResult result;
+    set<char> letters(first.variables.begin(), first.variables.end());
+    letters.insert(second.variables.begin(), second.variables.end());
+    result.variables.assign(letters.begin(), letters.end());
+    int varCount = result.variables.size();
     
-    if (groups.empty()) return "1"; // Always true or unsupported variable count
+    // Both sides over the shared variables; a minterm that is don't-care on
+    // either side is free on both
+    const KMapSolver* sides[2] = {&first, &second};
+    vector<Cube> onSets[2], free;
+    for (int s = 0; s < 2; s++) {
+        onSets[s] = remapCubes(sides[s]->onSetCubes(), sides[s]->variables, result.variables);
+        if (sides[s]->dontCares.getVariableCount() > 0) {
+            vector<Cube> listed = remapCubes(tableToCubes(sides[s]->dontCares), sides[s]->variables, result.variables);
+            free.insert(free.end(), listed.begin(), listed.end());
+        }
+    }
+    auto firstValue = [&](uint64_t minterm) {
+        return std::any_of(onSets[0].begin(), onSets[0].end(),
+                           [&](const Cube& cube) { return (minterm & cube.mask) == cube.value; });
+    };
     
-    // Combine terms
-    stringstream result;
-    for (size_t i = 0; i < groups.size(); ++i) {
-        // If any group is "1" (always true), the entire expression is "1"
-        if (groups[i].term == "1") {
-            return "1";
+    if (varCount > kMaxEquivalenceTableVariables) {
+        vector<int> levelBits(varCount);
+        for (int level = 0; level < varCount; level++) levelBits[level] = varCount - 1 - level;
+        Bdd bdd(levelBits);
+        // Past the truth table limit there is nothing to fall back to
+        if (varCount <= kMaxTruthTableVariables) bdd.setNodeLimit(kEquivalenceNodeLimit);
+        try {
+            Bdd::Ref f = bdd.fromCubes(onSets[0]), g = bdd.fromCubes(onSets[1]);
+            // Equal functions share one node, so most checks end here
+            if (f != g) {
+                Bdd::Ref diff = bdd.bddAnd(bdd.bddXor(f, g), Bdd::negate(bdd.fromCubes(free)));
+                result.equivalent = !bdd.pickMinterm(diff, result.counterexample);
+            }
+            if (!result.equivalent) result.firstValue = firstValue(result.counterexample);
+            return result;
+        } catch (const BddNodeLimitExceeded&) {
+            // Too large as a graph; compared as truth tables below
         }
-        if (i > 0) result << " + ";
-        result << groups[i].term;
     }
     
-    return result.str();
+    TruthTable tables[2] = {TruthTable(varCount), TruthTable(varCount)};
+    TruthTable ignored;
+    for (int s = 0; s < 2; s++) rasterizeCubes(onSets[s], tables[s]);
+    if (!free.empty()) {
+        ignored = TruthTable(varCount);
+        rasterizeCubes(free, ignored);
+    }
+    result.equivalent = !firstDifference(tables[0], tables[1], ignored, result.counterexample);
+    if (!result.equivalent) result.firstValue = tables[0].get(result.counterexample);
+    return result;
+}
+
+EquivalenceResult KMapSolver::equivalent(const string& first, const string& second) {
+    return equivalent(KMapSolver(first), KMapSolver(second));
 }
 
 // Terminal display functions
-void displayKMap(const vector<vector<bool>>& kmap, const vector<char>& variables) {
-    int rows = kmap.size();
-    int cols = kmap[0].size();
+void displayKMap(const KMap& kmap, const vector<char>& variables) {
+    int rows = kmap.getRowCount();
+    int cols = kmap.getColumnCount();
+    int colBits = variables.size() / 2;
+    int rowBits = variables.size() - colBits;
     
     // Print column headers with Gray code values
     cout << "    ";
@@ -384,172 +877,226 @@ void displayKMap(const vector<vector<bool>>& kmap, const vector<char>& variables
     for (int i = 0; i < rows; i++) {
         // Convert to Gray code
         int gray_i = i ^ (i >> 1);
-        // Convert to binary string
-        if (variables.size() == 2) {
-            // For 2 variables, show single bit for row
-            cout << setw(2) << (gray_i & 1);
-        } else {
-            // For 3+ variables, show 2 bits for row
-            string row_label = (gray_i & 2 ? "1" : "0") + string(gray_i & 1 ? "1" : "0");
-            cout << setw(2) << row_label;
+        // Convert to binary string, one bit per row variable
+        string row_label;
+        for (int bit = rowBits - 1; bit >= 0; bit--) {
+            row_label += (gray_i & (1 << bit)) ? "1" : "0";
         }
+        cout << setw(2) << row_label;
         cout << " |";
         
         for (int j = 0; j < cols; j++) {
-            cout << setw(4) << (kmap[i][j] ? "1" : "0");
+            cout << setw(4) << (kmap.get(i, j) ? "1" : kmap.isDontCare(i, j) ? "X" : "0");
         }
         cout << endl;
     }
     
     // Print variable mapping
     cout << "\nVariable Mapping:" << endl;
-    if (variables.size() == 2) {
-        cout << "Rows: " << variables[0] << " (in Gray code order)" << endl;
-        cout << "Columns: " << variables[1] << " (in Gray code order)" << endl;
-    } else if (variables.size() >= 3) {
-        cout << "Rows: " << variables[0] << variables[1] << " (in Gray code order)" << endl;
-        if (variables.size() == 3) {
-            cout << "Columns: " << variables[2] << endl;
-        } else if (variables.size() >= 4) {
-            cout << "Columns: " << variables[2] << variables[3] << " (in Gray code order)" << endl;
-        }
+    cout << "Rows: " << string(variables.begin(), variables.begin() + rowBits) << " (in Gray code order)" << endl;
+    cout << "Columns: " << string(variables.begin() + rowBits, variables.end());
+    if (colBits > 1 || variables.size() == 2) {
+        cout << " (in Gray code order)";
     }
+    cout << endl;
 }
 
 void displayMinimizedExpression(const string& expression) {
     cout << "Minimized Expression: " << expression << endl;
 }
 
-// Helper: generate all possible group sizes for a given K-map
-static std::vector<std::pair<int, int>> getGroupSizes(int rows, int cols) {
-    std::vector<std::pair<int, int>> sizes;
-    for (int h = rows; h >= 1; h /= 2) {
-        for (int w = cols; w >= 1; w /= 2) {
-            sizes.emplace_back(h, w);
-        }
-    }
-    return sizes;
+string cubeTerm(const vector<char>& variables, const Cube& cube) {
+    char term[kMaxTermLength];
+    return string(term, formatTerm(variables, cube, term));
+}
+
+string KMapSolver::getTerm(const Cube& cube) const {
+    return cubeTerm(variables, cube);
+}
+
+void KMapSolver::getMinimalCoverGroups(vector<KMapCubeGroup>& groups, bool& provenOptimal) const {
+    std::shared_ptr<const SolveResult> solved = getResult();
+    groups = solved->groups;
+    provenOptimal = solved->provenOptimal;
+}
+
+std::vector<KMapGroup> KMapSolver::getMinimalCoverGroups() const {
+    bool provenOptimal;
+    return getMinimalCoverGroups(provenOptimal);
 }
 
-// Helper: check if a group covers only 1s in the K-map
-static bool isAllOnes(const std::vector<std::vector<bool>>& kmap, int i, int j, int h, int w) {
-    int rows = kmap.size(), cols = kmap[0].size();
-    for (int di = 0; di < h; ++di)
-        for (int dj = 0; dj < w; ++dj)
-            if (!kmap[(i+di)%rows][(j+dj)%cols])
-                return false;
-    return true;
+std::vector<KMapGroup> KMapSolver::getMinimalCoverGroups(bool& provenOptimal) const {
+    vector<KMapCubeGroup> cubeGroups;
+    getMinimalCoverGroups(cubeGroups, provenOptimal);
+    
+    // Cell coordinates only depend on the layout, not on the function
+    KMap layout(TruthTable(std::min<int>(variables.size(), kMaxDisplayVariables)));
+    std::vector<KMapGroup> groups;
+    groups.reserve(cubeGroups.size());
+    for (const KMapCubeGroup& cubeGroup : cubeGroups) {
+        KMapGroup group;
+        group.cells = layout.getCells(cubeGroup);
+        group.term = getTerm(cubeGroup.cube);
+        groups.push_back(group);
+    }
+    return groups;
 }
 
-// Helper: get all cell coordinates for a group
-static std::vector<std::pair<int, int>> getGroupCells(int i, int j, int h, int w, int rows, int cols) {
-    std::vector<std::pair<int, int>> cells;
-    for (int di = 0; di < h; ++di)
-        for (int dj = 0; dj < w; ++dj)
-            cells.emplace_back((i+di)%rows, (j+dj)%cols);
-    return cells;
+// Helper: cubes, then literals
+static std::pair<size_t, size_t> coverCost(const Cube* cubes, size_t count) {
+    size_t literals = 0;
+    for (size_t i = 0; i < count; i++) literals += __builtin_popcountll(cubes[i].mask);
+    return {count, literals};
 }
 
-// Helper: check if a group is already in the list (by its cells)
-static bool groupExists(const std::vector<KMapGroup>& groups, const std::vector<std::pair<int, int>>& cells) {
-    for (const auto& g : groups) {
-        if (g.cells == cells) return true;
+void kmapWordCover(uint64_t onSet, uint64_t dontCares, int varCount, CubeList& primes, CubeList& cover,
+                   bool& provenOptimal, size_t& lowerBound, SolveBudget* budget) {
+    // 1. Every prime group, from the compile-time table for this size; primes
+    // grow through the don't-cares
+    findKMapPrimes(onSet | dontCares, varCount, primes);
+    if (dontCares) {
+        // The lookup table and NPN classes describe fully specified functions
+        selectCover(primes.data(), primes.size(), onSet, varCount, cover, &provenOptimal, &lowerBound, budget);
+    } else if (varCount <= kMaxCoverTableVariables) {
+        // Checked minimal when the table was generated
+        lookupMinimalCover(static_cast<uint16_t>(onSet), varCount, cover);
+        provenOptimal = true;
+    } else {
+        // Permuted and negated copies of a function share one solve
+        npnCoverCache().getCover(onSet, varCount,
+            [](uint64_t function, int count, CubeList& solved, bool& proven) {
+                // 2. Exact minimum cover of the 1 cells (essential groups first)
+                CubeList groups(solved.arena());
+                findKMapPrimes(function, count, groups);
+                selectCover(groups.data(), groups.size(), function, count, solved, &proven);
+            },
+            cover, provenOptimal);
     }
-    return false;
 }
 
-std::vector<KMapGroup> KMapSolver::getMinimalCoverGroups() const {
+// Runs the selected engine on a 2+ variable function and leaves its cover in
+// `cover`, sorted by term. `table` is only read up to kMaxTruthTableVariables.
+void KMapSolver::minimalCover(const TruthTable& table, const TruthTable& dontCares, const vector<Cube>& onSet,
+                              SolveResult& solved, CubeList& cover, SolveBudget& budget) const {
     int varCount = variables.size();
-    if (varCount < 2 || varCount > 4) return {};
-    std::vector<std::vector<bool>> kmap = const_cast<KMapSolver*>(this)->generateKMap();
-    int rows = kmap.size(), cols = kmap[0].size();
-    // 1. Find all prime implicants (all possible groups of 1s)
-    std::vector<KMapGroup> primes;
-    auto groupSizes = getGroupSizes(rows, cols);
-    for (auto sz : groupSizes) {
-        int h = sz.first, w = sz.second;
-        for (int i = 0; i < rows; ++i) {
-            for (int j = 0; j < cols; ++j) {
-                if (isAllOnes(kmap, i, j, h, w)) {
-                    auto cells = getGroupCells(i, j, h, w, rows, cols);
-                    std::sort(cells.begin(), cells.end());
-                    if (!groupExists(primes, cells)) {
-                        // Determine which variables are constant in this group
-                        int rowMask = 0, colMask = 0, rowVal = 0, colVal = 0;
-                        if (varCount == 2) {
-                            // For 2 variables: first var in rows, second var in columns
-                            // h=1 means row is constant, h=2 means row varies (first var eliminated)
-                            // w=1 means col is constant, w=2 means col varies (second var eliminated)
-                            rowMask = (h == 2) ? 1 : 0; // If h==2, first variable is eliminated (mask = 1)
-                            colMask = (w == 2) ? 1 : 0; // If w==2, second variable is eliminated (mask = 1)
-                            rowVal = i; // Row index gives first variable value
-                            colVal = j; // Column index gives second variable value
-                        } else if (varCount == 3) {
-                            rowMask = (h == 4) ? 3 : (h == 2 ? (1 << (1 - ((i/2)%2))) : (1 << (1 - (i%2))));
-                            rowVal = i%4;
-                            colMask = (w == 2) ? 1 : 0;
-                            colVal = j%2;
-                        } else if (varCount == 4) {
-                            // For 4 variables: first two in rows, last two in columns
-                            rowMask = 0; // Will be analyzed in getGroupTerm
-                            colMask = 0; // Will be analyzed in getGroupTerm  
-                            rowVal = i;
-                            colVal = j;
-                        }
-                        KMapGroup group;
-                        group.cells = cells;
-                        if (varCount == 4) {
-                            group.term = getGroupTermFromCells(variables, cells);
-                        } else {
-                            group.term = getGroupTerm(variables, rowMask, colMask, rowVal, colVal, varCount);
-                        }
-                        primes.push_back(group);
-                    }
-                }
-            }
+    bool& provenOptimal = solved.provenOptimal;
+    
+    // Primes grow through the don't-cares: they are generated over the care set
+    bool hasDontCares = dontCares.getVariableCount() > 0;
+    TruthTable careSet = hasDontCares ? careTable(table, dontCares) : TruthTable();
+    const TruthTable& care = hasDontCares ? careSet : table;
+    
+    bool cacheable = solutionCache && varCount <= kMaxTruthTableVariables;
+    SolutionCache::Key key{};
+    if (cacheable) {
+        key = SolutionCache::makeKey(table, dontCares, static_cast<uint32_t>(solved.engine));
+        if (solutionCache->find(key, cover, provenOptimal)) {
+            solved.fromCache = true;
+            sortByTerm(variables, cover);
+            return;
         }
     }
-    // 2. Build a table: which group covers which minterms
-    std::vector<std::pair<int, int>> minterms;
-    for (int i = 0; i < rows; ++i)
-        for (int j = 0; j < cols; ++j)
-            if (kmap[i][j]) minterms.emplace_back(i, j);
-    // 3. Find essential prime implicants
-    std::vector<KMapGroup> cover;
-    std::set<std::pair<int, int>> covered;
-    for (const auto& m : minterms) {
-        int count = 0, idx = -1;
-        for (size_t g = 0; g < primes.size(); ++g) {
-            if (std::find(primes[g].cells.begin(), primes[g].cells.end(), m) != primes[g].cells.end()) {
-                count++;
-                idx = g;
+    
+    vector<Cube> result;
+    vector<Cube> dcSet = hasDontCares ? tableToCubes(dontCares) : vector<Cube>();
+    switch (solved.engine) {
+        case MinimizerEngine::Espresso:
+            result = minimizeEspresso(onSet, dcSet, &budget);
+            break;
+        case MinimizerEngine::Bdd: {
+            Bdd bdd(siftVariableOrder(onSet, varCount, &budget));
+            bdd.setBudget(&budget);
+            try {
+                Bdd::Ref function = bdd.fromCubes(onSet);
+                result = bdd.isop(function, bdd.bddOr(function, bdd.fromCubes(dcSet)));
+            } catch (const SolveBudgetExpired&) {
+                // No cover on the graph yet: the products of the equation are one
+                result = onSet;
+            }
+            break;
+        }
+        case MinimizerEngine::Zdd:
+            result = minimizeImplicit(onSet, dcSet, varCount, &provenOptimal, &solved.primeStats, &budget);
+            solved.lowerBound = solved.primeStats.coverLowerBound;
+            break;
+        case MinimizerEngine::QuineMcCluskey: {
+            if (varCount > kMaxTruthTableVariables) {
+                throw std::runtime_error("The Quine-McCluskey engine supports up to " +
+                                         std::to_string(kMaxTruthTableVariables) + " variables");
             }
+            solved.primes = ::findPrimeImplicants(care, threadCount, &budget);
+            // Bounds over a partial prime set say nothing about the function, and
+            // the products of the equation are larger implicants to fall back on
+            bool allPrimes = !budget.expired();
+            if (!allPrimes) solved.primes.insert(solved.primes.end(), onSet.begin(), onSet.end());
+            result = selectCover(solved.primes, table, &provenOptimal, allPrimes ? &solved.lowerBound : nullptr,
+                                 &budget);
+            provenOptimal = provenOptimal && allPrimes;
+            break;
         }
-        if (count == 1 && covered.find(m) == covered.end()) {
-            // Only one group covers this minterm: essential
-            for (auto& cell : primes[idx].cells) covered.insert(cell);
-            cover.push_back(primes[idx]);
-        }
-    }
-    // 4. Cover remaining minterms with as few groups as possible (greedy for small K-maps)
-    while (covered.size() < minterms.size()) {
-        int best = -1, bestCount = 0;
-        for (size_t g = 0; g < primes.size(); ++g) {
-            int cnt = 0;
-            for (auto& cell : primes[g].cells)
-                if (kmap[cell.first][cell.second] && covered.find(cell) == covered.end())
-                    cnt++;
-            if (cnt > bestCount) {
-                best = g;
-                bestCount = cnt;
+        default: {
+            if (varCount > kMaxKMapKernelVariables) {
+                throw std::runtime_error("The K-map engine supports 2 to " +
+                                         std::to_string(kMaxKMapKernelVariables) + " variables");
+            }
+            CubeList primes(cover.arena());
+            if (varCount <= kMaxWordVariables) {
+                kmapWordCover(table.words()[0], hasDontCares ? dontCares.words()[0] : 0, varCount, primes, cover,
+                              provenOptimal, solved.lowerBound, &budget);
+            } else {
+                // 1. Every prime group, from the compile-time table for this size
+                findKMapPrimes(care, primes);
+                // 2. Exact minimum cover of the 1 cells (essential groups first)
+                result = selectCover(primes.data(), primes.size(), table, &provenOptimal, &solved.lowerBound,
+                                     &budget);
             }
+            solved.primes.assign(primes.begin(), primes.end());
+            break;
         }
-        if (best == -1) break; // Should not happen
-        for (auto& cell : primes[best].cells) covered.insert(cell);
-        cover.push_back(primes[best]);
     }
-    // Remove duplicate groups
-    std::sort(cover.begin(), cover.end(), [](const KMapGroup& a, const KMapGroup& b){ return a.term < b.term; });
-    cover.erase(std::unique(cover.begin(), cover.end(), [](const KMapGroup& a, const KMapGroup& b){ return a.term == b.term; }), cover.end());
-    return cover;
-} 
\ No newline at end of file
+    for (const Cube& cube : result) cover.push_back(cube);
+    // A search cut off early can end up worse than the products it started from
+    if (budget.expired() && coverCost(onSet.data(), onSet.size()) < coverCost(cover.data(), cover.size())) {
+        cover.clear();
+        for (const Cube& cube : onSet) cover.push_back(cube);
+    }
+    // A later solve with more time may do better than a cut-off one
+    if (cacheable && !budget.expired()) solutionCache->insert(key, cover.data(), cover.size(), provenOptimal);
+    sortByTerm(variables, cover);
+}
+
+// Repairs the previous Quine-McCluskey result for the edited `table`, leaving
+// the cover in `cover`, sorted by term. The don't-cares are those of the
+// previous result less any minterms the edit added.
+void KMapSolver::repairCover(const TruthTable& table, const TruthTable& dontCares, SolveResult& solved,
+                             CubeList& cover, SolveBudget& budget) const {
+    const TruthTable& before = previous->kmap.getTable();
+    solved.repaired = true;
+    if (table == before) {
+        // The edit kept the function: same primes, same cover
+        solved.primes = previous->primes;
+        solved.provenOptimal = previous->provenOptimal;
+        for (const Cube& cube : previous->cover) cover.push_back(cube);
+    } else {
+        bool hasDontCares = dontCares.getVariableCount() > 0;
+        solved.primes = hasDontCares ? repairPrimeImplicants(previous->primes,
+                                                             careTable(before, previous->kmap.getDontCares()),
+                                                             careTable(table, dontCares))
+                                     : repairPrimeImplicants(previous->primes, before, table);
+        for (const Cube& cube : ::repairCover(previous->cover, solved.primes, table, &budget)) {
+            cover.push_back(cube);
+        }
+    }
+    sortByTerm(variables, cover);
+}
+
+void KMapSolver::setSolutionCache(SolutionCache* cache) {
+    solutionCache = cache;
+    resetSnapshot();
+}
+
+void KMapSolver::setSolveBudget(uint64_t deadlineMs, uint64_t stepLimit) {
+    this->deadlineMs = deadlineMs;
+    this->stepLimit = stepLimit;
+    resetSnapshot();
+}
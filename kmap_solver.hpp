@@ -1,32 +1,129 @@
 #ifndef KMAP_SOLVER_HPP
 #define KMAP_SOLVER_HPP
 
+#include "truth_table.hpp"
+#include "kmap.hpp"
+#include "implicit_primes.hpp"
 #include <string>
 #include <vector>
 #include <map>
 #include <set>
+#include <memory>
+#include <mutex>
 
 using std::string;
 using std::vector;
 using std::map;
 using std::set;
 
+// Minimization backends behind getMinimalCoverGroups()/getMinimizedExpression()
+enum class MinimizerEngine {
+    Auto,           // K-map up to 8 variables, Quine-McCluskey up to 16, Espresso beyond
+    KMap,           // prime scan over compile-time group tables, 2-8 variables
+    QuineMcCluskey, // exact prime generation over the truth table
+    Espresso,       // heuristic EXPAND/IRREDUNDANT/REDUCE on the cube list, no truth table
+    Bdd,            // Minato-Morreale irredundant cover on a sifted BDD, no truth table
+    Zdd             // exact cover from primes generated implicitly as a ZDD, no truth table
+};
+
+// Parse a command-line engine name: auto, kmap, qm, espresso, bdd or zdd
+MinimizerEngine parseMinimizerEngine(const string& name);
+
+class CubeList;
+class SolutionCache;
+class SolveBudget;
+
+// Cell-list form of a group, kept for callers of the grid API
 struct KMapGroup {
     std::vector<std::pair<int, int>> cells; // coordinates in the K-map
     std::string term; // Boolean term for this group
 };
 
+// Everything one solve produces. It is built once per solver configuration and
+// never modified afterwards, so views and threads can share it freely.
+struct SolveResult {
+    vector<char> variables;
+    MinimizerEngine engine = MinimizerEngine::Auto; // the engine that ran
+    KMap kmap;                    // truth table and don't-cares in K-map layout, up to kMaxTruthTableVariables
+    vector<Cube> primes;          // every prime, from engines that list them (K-map, Quine-McCluskey)
+    vector<Cube> essentials;      // primes that alone cover some minterm
+    vector<Cube> cover;           // the minimal cover, sorted by term
+    vector<KMapCubeGroup> groups; // one per cover cube; cells only for drawable maps
+    string expression;
+    bool provenOptimal = false;   // false for heuristic engines or a cut-off search
+    size_t literalCount = 0;      // the cover costs cover.size() cubes and this many literals
+    size_t lowerBound = 0;        // no cover has fewer cubes; cover.size() when proven, 0 if unknown
+    bool budgetExpired = false;   // the solve budget ran out; the cover is the best found by then
+    bool fromCache = false;       // cover read from the persistent cache (no primes then)
+    bool repaired = false;        // primes and cover repaired from the result before an edit
+    ImplicitPrimeStats primeStats; // Zdd engine only
+};
+
+// Widest function KMapSolver::equivalent() compares by truth table; wider ones
+// are compared as BDDs first, and only as BDDs past kMaxTruthTableVariables
+const int kMaxEquivalenceTableVariables = 20;
+
+// Outcome of KMapSolver::equivalent()
+struct EquivalenceResult {
+    bool equivalent = true;
+    vector<char> variables;      // every variable of either side, in order
+    uint64_t counterexample = 0; // a minterm over `variables` where the sides differ
+    bool firstValue = false;     // the first side's value there; the second has the other
+};
+
+// Sum-of-products and product-of-sums forms of one function
+struct DualFormResult {
+    std::shared_ptr<const SolveResult> sop;     // the snapshot getResult() returns
+    std::shared_ptr<const SolveResult> offSet;  // minimal cover of the complement; each cube is one sum of the POS
+    string posExpression;                       // e.g. (A + B')C
+    bool posCheaper = false;                    // the POS has fewer sums, or as many and fewer literals
+};
+
 class KMapSolver {
+    friend class MultiOutputSolver;
 public:
+    // An equation is a sum of '+' separated terms: products such as A'BC,
+    // minterm lists m(1,3,5), don't-care lists d(2,6) and hex truth tables
+    // 0xF0E1 (the last digit holds minterms 0-3). Lists and tables number the
+    // variables A, B, C, ... from the most significant minterm bit; without a
+    // variable count they use as many as their largest index or digit count needs.
     KMapSolver(const string& equation);
     KMapSolver(const string& equation, int expectedVariableCount);
     KMapSolver(const string& equation, const vector<char>& expectedVariables);
+    // Function loaded straight from bit buffers in TruthTable word layout (bit m
+    // of word m / 64 is minterm m) over variables A, B, C, ...; the equation
+    // starts empty and any terms added later extend it
+    KMapSolver(const uint64_t* onSet, int varCount, const uint64_t* dontCares = nullptr);
     
-    // Main solving function
-    vector<vector<bool>> solve() const;
+    // Solve once and return the snapshot; later calls share it until a setter
+    // changes the configuration. Safe to call from several threads.
+    std::shared_ptr<const SolveResult> getResult() const;
+
+    // Both two-level forms from one truth table: the off-set is its bitwise
+    // complement (outside the don't-cares), and the on-set and off-set are
+    // minimized concurrently, each on its thread's cube arena. The SOP half
+    // becomes the snapshot, and reuses it when one has already been solved.
+    DualFormResult getDualForm() const;
+    
+    // The K-map of the equation (2 to 26 variables)
+    void solve(KMap& kmap) const;
+    vector<vector<bool>> solve() const; // grid adapter
     
-    // Get the minimized boolean expression
+    // Get the minimized boolean expression; provenOptimal tells whether the
+    // cover is a proven minimum (false for heuristic engines or a cut-off search)
     string getMinimizedExpression() const;
+    string getMinimizedExpression(bool& provenOptimal) const;
+    
+    // Edit the equation over the same variables. The next solve starts from the
+    // previous result: only the minterms of added and removed terms are
+    // recomputed, and with the Quine-McCluskey engine the primes and cover are
+    // repaired around the minterms that changed instead of being rebuilt. A
+    // repaired cover is irredundant, but only proven minimal when it is all
+    // essential primes; it skips the persistent cache.
+    void setEquation(const string& equation);
+    void addTerm(const string& term);
+    void removeTerm(const string& term); // first product with the same literals
+    const string& getEquation() const;
     
     // Get the number of variables in the equation
     int getVariableCount() const;
@@ -34,29 +131,121 @@ public:
     // Get the list of variables used in the equation
     vector<char> getVariables() const;
 
-    std::vector<KMapGroup> getMinimalCoverGroups() const; // For GUI highlighting
+    // Groups of the minimal cover, sorted by term, for highlighting
+    void getMinimalCoverGroups(vector<KMapCubeGroup>& groups, bool& provenOptimal) const;
+    std::vector<KMapGroup> getMinimalCoverGroups() const; // cell-list adapters
+    std::vector<KMapGroup> getMinimalCoverGroups(bool& provenOptimal) const;
+
+    // Printed term of a cube over this equation's variables
+    string getTerm(const Cube& cube) const;
+    
+    // Select how the truth table is computed (Auto by default)
+    void setEvaluationMode(EvaluationMode mode);
+    EvaluationMode getEvaluationMode() const;
+    
+    // Worker threads for truth-table generation and Quine-McCluskey prime
+    // generation (0 = one per hardware thread)
+    void setThreadCount(int count);
+    int getThreadCount() const;
+    
+    // Select the minimization backend (Auto by default)
+    void setEngine(MinimizerEngine engine);
+    MinimizerEngine getEngine() const;
+
+    // Prime counts and peak node counts of the Zdd engine run
+    ImplicitPrimeStats getPrimeStats() const;
+
+    // Persistent cover cache consulted before solving (none by default; not owned)
+    void setSolutionCache(SolutionCache* cache);
+
+    // Bound every solve by wall-clock time and search steps (0 = no limit, the
+    // default). A solve that runs out still returns a valid cover, the best
+    // found by then, marked budgetExpired; compare its size with lowerBound for
+    // the optimality gap. Budget-limited covers are not stored in the cache.
+    void setSolveBudget(uint64_t deadlineMs, uint64_t stepLimit = 0);
+    uint64_t getDeadlineMs() const { return deadlineMs; }
+    uint64_t getStepLimit() const { return stepLimit; }
+
+    // Whether two equations define the same function over the union of their
+    // variables, a minterm being free where either side lists it as don't-care.
+    // Small functions are compared word by word as truth tables, stopping at
+    // the first differing word; wide ones as BDDs, which are canonical, for any
+    // number of variables (minterm lists and don't-cares enter as cubes). Every
+    // solve runs the same table check on its own cover before returning it.
+    static EquivalenceResult equivalent(const KMapSolver& first, const KMapSolver& second);
+    static EquivalenceResult equivalent(const string& first, const string& second);
 
 private:
     string equation;
     vector<char> variables;
-    map<char, bool> variableValues;
-    vector<vector<bool>> kmap;
+    
+    // Equation compiled once into flat literal runs; product p spans
+    // literals[productEnds[p-1] .. productEnds[p])
+    vector<Literal> literals;
+    vector<uint32_t> productEnds;
+    vector<Cube> cubes; // the same products as (care mask, value) cubes
+    // Minterms and don't-cares listed by m(...), hex tables and d(...), plus
+    // those loaded from bit buffers; no variables when there are none
+    TruthTable listedOnSet, dontCares;
+    TruthTable loadedOnSet, loadedDontCares;
+    EvaluationMode evaluationMode = EvaluationMode::Auto;
+    int threadCount = 1;
+    MinimizerEngine engine = MinimizerEngine::Auto;
+    SolutionCache* solutionCache = nullptr;
+    uint64_t deadlineMs = 0, stepLimit = 0;
+    
+    // Lazily computed snapshot, dropped whenever the configuration changes
+    mutable std::mutex resultMutex;
+    mutable std::shared_ptr<const SolveResult> snapshot;
+    // Snapshot from before the pending equation edits, and its products
+    mutable std::shared_ptr<const SolveResult> previous;
+    mutable vector<Cube> previousCubes;
     
     // Helper functions
     void parseEquation();
     void parseEquation(int expectedVariableCount);
     void parseEquation(const vector<char>& expectedVariables);
-    bool evaluateExpression(const string& expr);
-    vector<vector<bool>> generateKMap();
-    string minimizeExpression() const;
+    void compileEquation();
+    TruthTable buildTruthTable() const;
+    vector<Cube> onSetCubes() const;
+    MinimizerEngine resolveEngine() const;
+    void resetSnapshot();
+    std::shared_ptr<const SolveResult> computeResult() const;
+    bool buildFunction(TruthTable& table, TruthTable& free) const;
+    std::shared_ptr<SolveResult> solveFunction(const TruthTable& table, const TruthTable& free,
+                                               const vector<Cube>& onSet, bool repair) const;
+    void minimalCover(const TruthTable& table, const TruthTable& dontCares, const vector<Cube>& onSet,
+                      SolveResult& result, CubeList& cover, SolveBudget& budget) const;
+    void repairCover(const TruthTable& table, const TruthTable& dontCares, SolveResult& result,
+                     CubeList& cover, SolveBudget& budget) const;
     set<string> findPrimeImplicants() const;
     set<string> findEssentialPrimeImplicants(const set<string>& primeImplicants) const;
     vector<string> findGroups(const vector<vector<bool>>& kmap) const;
     string combineTerms(const vector<string>& groups) const;
 };
 
+// Cubes over `from` rewritten over `to`, which holds every variable of `from`
+vector<Cube> remapCubes(const vector<Cube>& cubes, const vector<char>& from, const vector<char>& to);
+
+// Printed term of a cube over `variables` ("1" when it has no literals)
+string cubeTerm(const vector<char>& variables, const Cube& cube);
+
+// K-map engine on a 2 to kMaxWordVariables variable function given as its truth
+// table words: appends the primes of the on-set plus don't-cares to `primes` and
+// a minimal cover to `cover` (from the cover table up to 4 variables, the NPN
+// cache for larger functions without don't-cares, an exact cover otherwise).
+// Both lists and all scratch share one arena, so with a warmed-up arena and
+// cache it runs without heap allocations.
+void kmapWordCover(uint64_t onSet, uint64_t dontCares, int varCount, CubeList& primes, CubeList& cover,
+                   bool& provenOptimal, size_t& lowerBound, SolveBudget* budget = nullptr);
+
+// On-set minterms no two of which fit in one implicant (the cube spanning them
+// leaves the care set), picked greedily from an even sample of the on-set;
+// every cover needs a separate cube for each, so their count bounds its size
+size_t independentMinterms(const TruthTable& table, const TruthTable& care);
+
 // Terminal display functions
-void displayKMap(const vector<vector<bool>>& kmap, const vector<char>& variables);
+void displayKMap(const KMap& kmap, const vector<char>& variables);
 void displayMinimizedExpression(const string& expression);
 
 #endif // KMAP_SOLVER_HPP 
\ No newline at end of file
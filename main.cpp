@@ -1,55 +1,213 @@
 #include "kmap_solver.hpp"
+#include "solution_cache.hpp"
+#include "multi_output_solver.hpp"
 #include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <memory>
+#include <sstream>
 
 using std::cout;
 using std::cerr;
 using std::endl;
 
 void printUsage(const char* programName) {
-    cout << "Usage: " << programName << " <boolean_equation> [num_variables]" << endl;
+    cout << "Usage: " << programName << " [options] <boolean_equation> [num_variables]" << endl;
     cout << "Example: " << programName << " \"AB + BC\"" << endl;
     cout << "Example: " << programName << " \"BD + B'D'\" 4   # Force 4 variables (A,B,C,D)" << endl;
+    cout << "Example: " << programName << " \"m(1,3,5,7) + d(2,6)\"   # Minterms and don't-cares" << endl;
+    cout << "Example: " << programName << " 0xF0E1   # Truth table in hex, minterm 0 in the lowest bit" << endl;
+    cout << "Example: " << programName << " --outputs \"AB + C; AB + D\"   # Two outputs sharing AB" << endl;
     cout << "Note: Use quotes around the equation if it contains spaces" << endl;
     cout << "      If num_variables is specified, variables A,B,C,D,... will be used" << endl;
+    cout << "Options:" << endl;
+    cout << "  --threads N      Worker threads for truth tables and prime generation (0 = all cores)" << endl;
+    cout << "  --engine NAME    Minimizer: auto, kmap, qm, espresso, bdd or zdd (default auto)" << endl;
+    cout << "  --cache FILE     Reuse covers from a persistent cache file (created if missing)" << endl;
+    cout << "  --deadline-ms N  Stop searching after N ms and print the best cover found" << endl;
+    cout << "  --pos            Also print the minimal product of sums and which form is cheaper" << endl;
+    cout << "  --outputs        The equation is ';' separated outputs, minimized together so that" << endl;
+    cout << "                   they share product terms (no K-map display, cache or engine choice)" << endl;
+    cout << "  --equivalent EQ  Only check whether EQ is the same function as the equation and print" << endl;
+    cout << "                   a differing assignment if not (exit status 2 when they differ)" << endl;
 }
 
 int main(int argc, char* argv[]) {
-    if (argc < 2 || argc > 3) {
+    // Split options from the positional equation / variable count arguments
+    vector<string> positional;
+    int threadCount = 1;
+    string engineName = "auto";
+    string cachePath;
+    long long deadlineMs = 0;
+    string otherEquation;
+    bool checkEquivalence = false;
+    bool dualForm = false;
+    bool multiOutput = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threadCount = std::atoi(argv[++i]);
+            if (threadCount < 0) {
+                cerr << "Error: Thread count must not be negative" << endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--engine") == 0 && i + 1 < argc) {
+            engineName = argv[++i];
+        } else if (std::strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            cachePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--deadline-ms") == 0 && i + 1 < argc) {
+            deadlineMs = std::atoll(argv[++i]);
+            if (deadlineMs <= 0) {
+                cerr << "Error: Deadline must be a positive number of milliseconds" << endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--pos") == 0) {
+            dualForm = true;
+        } else if (std::strcmp(argv[i], "--outputs") == 0) {
+            multiOutput = true;
+        } else if (std::strcmp(argv[i], "--equivalent") == 0 && i + 1 < argc) {
+            otherEquation = argv[++i];
+            checkEquivalence = true;
+        } else {
+            positional.push_back(argv[i]);
+        }
+    }
+    
+    if (positional.size() < 1 || positional.size() > 2) {
         printUsage(argv[0]);
         return 1;
     }
 
-    string equation = argv[1];
+    string equation = positional[0];
     
     try {
-        KMapSolver* solver = nullptr;
+        if (multiOutput) {
+            vector<string> equations;
+            std::stringstream ss(equation);
+            string output;
+            while (std::getline(ss, output, ';')) equations.push_back(output);
+            std::unique_ptr<MultiOutputSolver> outputs;
+            if (positional.size() == 2) {
+                int numVars = std::stoi(positional[1]);
+                if (numVars < 2 || numVars > kMaxTruthTableVariables) {
+                    cerr << "Error: Number of variables must be between 2 and " << kMaxTruthTableVariables << endl;
+                    return 1;
+                }
+                vector<char> variables;
+                for (int k = 0; k < numVars; k++) variables.push_back('A' + k);
+                outputs.reset(new MultiOutputSolver(equations, variables));
+            } else {
+                outputs.reset(new MultiOutputSolver(equations));
+            }
+            outputs->setThreadCount(threadCount);
+            outputs->setSolveBudget(deadlineMs);
+            MultiOutputResult shared = outputs->solve();
+            for (size_t i = 0; i < shared.expressions.size(); i++) {
+                cout << "F" << i + 1 << " = " << shared.expressions[i] << endl;
+            }
+            cout << "Shared products: " << shared.products.size() << " (" << shared.literalCount << " literals, "
+                 << shared.connectionCount << " connections, from " << shared.primeCount << " primes)" << endl;
+            cout << "Cover: " << (shared.provenOptimal ? "proven minimal" : "best found (minimality not proven)") << endl;
+            if (shared.budgetExpired) {
+                cout << "Deadline: reached after " << deadlineMs << " ms";
+                if (shared.lowerBound > 0) cout << "; at least " << shared.lowerBound << " products needed";
+                cout << endl;
+            }
+            return 0;
+        }
+        
+        std::unique_ptr<KMapSolver> solver;
         
-        if (argc == 3) {
+        if (positional.size() == 2) {
             // Number of variables specified
-            int numVars = std::stoi(argv[2]);
-            if (numVars < 2 || numVars > 4) {
-                cerr << "Error: Number of variables must be between 2 and 4" << endl;
+            int numVars = std::stoi(positional[1]);
+            if (numVars < 2 || numVars > kMaxTruthTableVariables) {
+                cerr << "Error: Number of variables must be between 2 and " << kMaxTruthTableVariables << endl;
                 return 1;
             }
-            solver = new KMapSolver(equation, numVars);
+            solver.reset(new KMapSolver(equation, numVars));
         } else {
             // Auto-detect variables from equation
-            solver = new KMapSolver(equation);
+            solver.reset(new KMapSolver(equation));
+        }
+        if (checkEquivalence) {
+            // Both sides use the same variable count rule
+            std::unique_ptr<KMapSolver> other(positional.size() == 2
+                                                  ? new KMapSolver(otherEquation, solver->getVariableCount())
+                                                  : new KMapSolver(otherEquation));
+            EquivalenceResult check = KMapSolver::equivalent(*solver, *other);
+            if (check.equivalent) {
+                cout << "Equivalent: " << equation << " == " << otherEquation << endl;
+                return 0;
+            }
+            int varCount = check.variables.size();
+            cout << "Not equivalent at";
+            for (int k = 0; k < varCount; k++) {
+                cout << " " << check.variables[k] << "=" << ((check.counterexample >> (varCount - 1 - k)) & 1);
+            }
+            cout << " (minterm " << check.counterexample << "): " << equation << " = " << check.firstValue << ", "
+                 << otherEquation << " = " << !check.firstValue << endl;
+            return 2;
+        }
+        solver->setThreadCount(threadCount);
+        solver->setEngine(parseMinimizerEngine(engineName));
+        solver->setSolveBudget(deadlineMs);
+        std::unique_ptr<SolutionCache> cache;
+        if (!cachePath.empty()) {
+            cache.reset(new SolutionCache(cachePath));
+            solver->setSolutionCache(cache.get());
         }
         
-        // Generate and display the K-map
-        vector<vector<bool>> kmap = solver->solve();
+        if (solver->getVariableCount() < 2) {
+            cerr << "Error: Only 2 to " << kMaxTruthTableVariables << " variables are supported" << endl;
+            return 1;
+        }
+        
+        // One solve pass feeds everything printed below; with --pos it also
+        // minimizes the complement of the same truth table
+        DualFormResult dual;
+        if (dualForm) dual = solver->getDualForm();
+        std::shared_ptr<const SolveResult> result = dualForm ? dual.sop : solver->getResult();
+        
+        // Display the K-map (wide functions are only minimized)
+        bool showGrid = solver->getVariableCount() <= kMaxDisplayVariables;
         cout << "K-map for equation: " << equation << endl;
-        if (argc == 3) {
-            cout << "Using " << argv[2] << " variables (A,B,C,D...)" << endl;
+        if (positional.size() == 2) {
+            cout << "Using " << positional[1] << " variables (A,B,C,D...)" << endl;
+        }
+        if (showGrid) {
+            displayKMap(result->kmap, result->variables);
+        } else {
+            cout << "(K-map grid omitted for more than " << kMaxDisplayVariables << " variables)" << endl;
         }
-        displayKMap(kmap, solver->getVariables());
         
         // Display the minimized expression
-        string minimized = solver->getMinimizedExpression();
-        displayMinimizedExpression(minimized);
-        
-        delete solver;
+        displayMinimizedExpression(result->expression);
+        cout << "Cover: " << (result->provenOptimal ? "proven minimal" : "best found (minimality not proven)") << endl;
+        if (dualForm) {
+            cout << "Product of sums: " << dual.posExpression << endl;
+            cout << "Cheaper form: " << (dual.posCheaper ? "product of sums (" : "sum of products (")
+                 << result->cover.size() << " terms, " << result->literalCount << " literals vs "
+                 << dual.offSet->cover.size() << " sums, " << dual.offSet->literalCount << " literals)" << endl;
+        }
+        if (result->budgetExpired) {
+            cout << "Deadline: reached after " << deadlineMs << " ms; cover has " << result->cover.size()
+                 << " terms and " << result->literalCount << " literals";
+            // Functions too wide for a truth table may come without a bound
+            if (result->lowerBound > 0) cout << ", at least " << result->lowerBound << " terms needed";
+            cout << endl;
+        }
+        if (result->engine == MinimizerEngine::Zdd && !result->fromCache) {
+            const ImplicitPrimeStats& stats = result->primeStats;
+            cout << "Primes: " << stats.primeCount << " (" << stats.essentialCount << " essential, "
+                 << stats.dominatedCount << " dominated, " << stats.corePrimeCount << " in cyclic core)" << endl;
+            cout << "Peak nodes: " << stats.peakBddNodes << " BDD, " << stats.peakZddNodes << " ZDD" << endl;
+        }
+        if (cache) {
+            uint64_t lookups = cache->getLifetimeLookups();
+            double rate = lookups ? 100.0 * cache->getLifetimeHits() / lookups : 0.0;
+            cout << "Cache: " << (result->fromCache ? "hit" : "miss") << " (" << cache->getLifetimeHits() << " of "
+                 << lookups << " lookups hit, " << std::fixed << std::setprecision(1) << rate << "%)" << endl;
+        }
         
     } catch (const std::exception& e) {
         cerr << "Error: " << e.what() << endl;
@@ -0,0 +1,285 @@
+#include "multi_output_solver.hpp"
+#include "kmap_solver.hpp"
+#include "quine_mccluskey.hpp"
+#include "cover_solver.hpp"
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <stdexcept>
+
+// Bit i set for output i
+using OutputSet = uint32_t;
+
+MultiOutputSolver::MultiOutputSolver(const vector<string>& equations) {
+    load(equations, nullptr);
+}
+
+MultiOutputSolver::MultiOutputSolver(const vector<string>& equations, const vector<char>& variables) {
+    load(equations, &variables);
+}
+
+void MultiOutputSolver::load(const vector<string>& equations, const vector<char>* expectedVariables) {
+    if (equations.empty() || equations.size() > size_t(kMaxMultiOutputs)) {
+        throw std::runtime_error("Only 1 to " + std::to_string(kMaxMultiOutputs) + " outputs are supported");
+    }
+    // Each equation is parsed and compiled once; its products and listed
+    // minterms are then rewritten over the shared variables
+    vector<std::unique_ptr<KMapSolver>> solvers;
+    std::set<char> letters;
+    for (const string& equation : equations) {
+        solvers.emplace_back(expectedVariables ? new KMapSolver(equation, *expectedVariables) : new KMapSolver(equation));
+        letters.insert(solvers.back()->variables.begin(), solvers.back()->variables.end());
+    }
+    variables.assign(letters.begin(), letters.end());
+    int varCount = variables.size();
+    if (varCount < 2 || varCount > kMaxTruthTableVariables) {
+        throw std::runtime_error("Only 2 to " + std::to_string(kMaxTruthTableVariables) + " variables are supported");
+    }
+    for (const auto& solver : solvers) {
+        onSets.push_back(remapCubes(solver->onSetCubes(), solver->variables, variables));
+        dontCareSets.push_back(solver->dontCares.getVariableCount() > 0
+                                   ? remapCubes(tableToCubes(solver->dontCares), solver->variables, variables)
+                                   : vector<Cube>());
+    }
+}
+
+void MultiOutputSolver::setThreadCount(int count) {
+    if (count < 0) {
+        throw std::runtime_error("Thread count must not be negative");
+    }
+    threadCount = count;
+}
+
+void MultiOutputSolver::setSolveBudget(uint64_t deadlineMs, uint64_t stepLimit) {
+    this->deadlineMs = deadlineMs;
+    this->stepLimit = stepLimit;
+}
+
+MultiOutputResult MultiOutputSolver::solve() const {
+    MultiOutputResult result;
+    result.variables = variables;
+    int varCount = variables.size();
+    int outputCount = onSets.size();
+    SolveBudget budget(deadlineMs, stepLimit);
+
+    // 1. Every output's on-set and care set (on-set plus don't-cares) in one
+    // sweep: each block of words is filled for all outputs before the next
+    vector<TruthTable> on(outputCount, TruthTable(varCount)), care(outputCount, TruthTable(varCount));
+    size_t wordCount = on[0].wordCount();
+    forEachWordBlock(wordCount, threadCount, [&](size_t begin, size_t end) {
+        for (int i = 0; i < outputCount; i++) {
+            rasterizeCubes(onSets[i], on[i], begin, end);
+            rasterizeCubes(dontCareSets[i], care[i], begin, end);
+            for (size_t w = begin; w < end; w++) care[i].words()[w] |= on[i].words()[w];
+        }
+    });
+
+    // 2. Primes of the product of each combination of outputs whose care sets
+    // overlap. A prime of a product is also prime for the product of every
+    // output containing it, and those outputs become its tag. Single outputs
+    // come first, so a cut-off budget still leaves primes covering each of them.
+    std::map<Cube, OutputSet> tags;
+    auto addPrimes = [&](const TruthTable& product) {
+        for (const Cube& prime : findPrimeImplicants(product, threadCount, &budget)) {
+            if (tags.count(prime)) continue;
+            OutputSet tag = 0;
+            bool useful = false;
+            for (int i = 0; i < outputCount; i++) {
+                if (!care[i].containsCube(prime)) continue;
+                tag |= OutputSet(1) << i;
+                forEachCubeWord(prime, on[i], [&](uint64_t w, uint64_t pattern) {
+                    useful |= (pattern & on[i].words()[w]) != 0;
+                });
+            }
+            // Primes inside don't-cares alone cover nothing
+            if (useful) tags.emplace(prime, tag);
+        }
+    };
+    for (int i = 0; i < outputCount; i++) addPrimes(care[i]);
+    // Depth first, so only one product per combination size is held at a time
+    std::function<void(const TruthTable&, int)> extend = [&](const TruthTable& product, int last) {
+        for (int j = last + 1; j < outputCount && !budget.expired(); j++) {
+            TruthTable next = product;
+            bool overlaps = false;
+            for (size_t w = 0; w < wordCount; w++) {
+                next.words()[w] &= care[j].words()[w];
+                overlaps |= next.words()[w] != 0;
+            }
+            if (!overlaps) continue;
+            // Equal products have the same primes
+            if (next != product && next != care[j]) addPrimes(next);
+            extend(next, j);
+        }
+    };
+    for (int i = 0; i + 1 < outputCount && !budget.expired(); i++) extend(care[i], i);
+    bool primesComplete = !budget.expired();
+
+    vector<Cube> primes;
+    vector<OutputSet> primeTags;
+    for (const auto& entry : tags) {
+        primes.push_back(entry.first);
+        primeTags.push_back(entry.second);
+    }
+    uint32_t primeCount = primes.size();
+    result.primeCount = primeCount;
+
+    // 3. One covering problem whose rows are the (output, on-set minterm)
+    // pairs, numbered output by output; a prime covers the rows of the outputs
+    // in its tag
+    vector<vector<uint32_t>> prefix(outputCount, vector<uint32_t>(wordCount + 1, 0));
+    vector<uint32_t> base(outputCount + 1, 0);
+    for (int i = 0; i < outputCount; i++) {
+        for (size_t w = 0; w < wordCount; w++) {
+            prefix[i][w + 1] = prefix[i][w] + __builtin_popcountll(on[i].words()[w]);
+        }
+        base[i + 1] = base[i] + prefix[i][wordCount];
+    }
+    uint32_t rowCount = base[outputCount];
+    auto forEachOutputRow = [&](uint32_t p, int i, auto&& body) {
+        const vector<uint64_t>& words = on[i].words();
+        forEachCubeWord(primes[p], on[i], [&](uint64_t w, uint64_t pattern) {
+            for (uint64_t bits = pattern & words[w]; bits; bits &= bits - 1) {
+                uint64_t below = words[w] & ((uint64_t(1) << __builtin_ctzll(bits)) - 1);
+                body(base[i] + prefix[i][w] + static_cast<uint32_t>(__builtin_popcountll(below)));
+            }
+        });
+    };
+    auto forEachRow = [&](uint32_t p, auto&& body) {
+        for (int i = 0; i < outputCount; i++) {
+            if (primeTags[p] >> i & 1) forEachOutputRow(p, i, body);
+        }
+    };
+
+    // Row -> covering primes, in CSR layout
+    vector<uint32_t> offsets(rowCount + 1, 0);
+    for (uint32_t p = 0; p < primeCount; p++) forEachRow(p, [&](uint32_t r) { offsets[r + 1]++; });
+    for (uint32_t r = 0; r < rowCount; r++) offsets[r + 1] += offsets[r];
+    vector<uint32_t> coverers(offsets[rowCount]);
+    vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (uint32_t p = 0; p < primeCount; p++) forEachRow(p, [&](uint32_t r) { coverers[fill[r]++] = p; });
+
+    vector<uint32_t> chosen;
+    vector<char> taken(primeCount, 0), covered(rowCount, 0);
+    auto take = [&](uint32_t p) {
+        taken[p] = 1;
+        chosen.push_back(p);
+        forEachRow(p, [&](uint32_t r) { covered[r] = 1; });
+    };
+    // Essential primes: the only prime covering some row
+    for (uint32_t r = 0; r < rowCount; r++) {
+        if (offsets[r + 1] - offsets[r] == 1 && !taken[coverers[offsets[r]]]) take(coverers[offsets[r]]);
+    }
+    size_t essentialCount = chosen.size();
+
+    // The uncovered rows form the cyclic core; identical rows collapse into one.
+    // A product costs one whichever outputs use it, then its literals.
+    vector<vector<uint32_t>> rows;
+    for (uint32_t r = 0; r < rowCount; r++) {
+        if (!covered[r]) rows.emplace_back(coverers.begin() + offsets[r], coverers.begin() + offsets[r + 1]);
+    }
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    vector<int32_t> columnOf(primeCount, -1);
+    vector<uint32_t> columnPrime;
+    vector<uint64_t> costs;
+    for (auto& row : rows) {
+        for (uint32_t& p : row) {
+            if (columnOf[p] < 0) {
+                columnOf[p] = static_cast<int32_t>(columnPrime.size());
+                columnPrime.push_back(p);
+                costs.push_back((uint64_t(1) << 32) + __builtin_popcountll(primes[p].mask));
+            }
+            p = static_cast<uint32_t>(columnOf[p]);
+        }
+    }
+    CoverSolution solution = solveUnateCover(rows, costs, kDefaultCoverNodeLimit, &budget);
+    for (uint32_t c : solution.columns) chosen.push_back(columnPrime[c]);
+    result.provenOptimal = primesComplete && solution.provenOptimal;
+    if (primesComplete) {
+        result.lowerBound = essentialCount + (solution.lowerBound >> 32);
+    } else {
+        // Essentials and the covering bound only hold over every prime; each
+        // output alone still needs as many products as its own cover would
+        for (int i = 0; i < outputCount; i++) {
+            result.lowerBound = std::max(result.lowerBound, independentMinterms(on[i], care[i]));
+        }
+    }
+
+    // 4. Each output keeps the chosen products that serve it, dropping those
+    // whose rows of that output are covered twice over, most literals first
+    vector<uint32_t> uses(rowCount, 0);
+    for (uint32_t p : chosen) forEachRow(p, [&](uint32_t r) { uses[r]++; });
+    std::stable_sort(chosen.begin(), chosen.end(), [&](uint32_t a, uint32_t b) {
+        return __builtin_popcountll(primes[a].mask) > __builtin_popcountll(primes[b].mask);
+    });
+    vector<vector<uint32_t>> serves(outputCount);
+    for (uint32_t p : chosen) {
+        for (int i = 0; i < outputCount; i++) {
+            if (!(primeTags[p] >> i & 1)) continue;
+            bool needed = false;
+            forEachOutputRow(p, i, [&](uint32_t r) { needed |= uses[r] == 1; });
+            if (needed) {
+                serves[i].push_back(p);
+            } else {
+                forEachOutputRow(p, i, [&](uint32_t r) { uses[r]--; });
+            }
+        }
+    }
+
+    // Products no output kept are dropped; the rest are listed by term
+    vector<uint32_t> used;
+    for (const vector<uint32_t>& primesOfOutput : serves) used.insert(used.end(), primesOfOutput.begin(), primesOfOutput.end());
+    std::sort(used.begin(), used.end());
+    used.erase(std::unique(used.begin(), used.end()), used.end());
+    vector<string> terms(primeCount);
+    for (uint32_t p : used) terms[p] = cubeTerm(variables, primes[p]);
+    std::sort(used.begin(), used.end(), [&](uint32_t a, uint32_t b) { return terms[a] < terms[b]; });
+    vector<uint32_t> productOf(primeCount, 0);
+    for (uint32_t k = 0; k < used.size(); k++) {
+        productOf[used[k]] = k;
+        result.products.push_back(primes[used[k]]);
+        result.literalCount += __builtin_popcountll(primes[used[k]].mask);
+    }
+    if (result.provenOptimal) {
+        result.lowerBound = result.products.size();
+    } else {
+        result.lowerBound = std::min(result.lowerBound, result.products.size());
+    }
+
+    result.outputs.resize(outputCount);
+    result.expressions.resize(outputCount);
+    for (int i = 0; i < outputCount; i++) {
+        vector<uint32_t>& indices = result.outputs[i];
+        for (uint32_t p : serves[i]) indices.push_back(productOf[p]);
+        std::sort(indices.begin(), indices.end());
+        result.connectionCount += indices.size();
+
+        // Self-check: each output's cover must agree with it outside its don't-cares
+        vector<Cube> cover;
+        for (uint32_t k : indices) cover.push_back(result.products[k]);
+        TruthTable covered(varCount), free = care[i];
+        rasterizeCubes(cover, covered);
+        for (size_t w = 0; w < wordCount; w++) free.words()[w] &= ~on[i].words()[w];
+        uint64_t minterm;
+        if (firstDifference(covered, on[i], free, minterm)) {
+            throw std::runtime_error("Self-check failed: the cover of output " + std::to_string(i + 1) +
+                                     " differs from its equation at minterm " + std::to_string(minterm));
+        }
+
+        string& expression = result.expressions[i];
+        if (cover.empty()) {
+            expression = "0";
+        } else if (std::any_of(cover.begin(), cover.end(), [](const Cube& cube) { return cube.mask == 0; })) {
+            expression = "1";
+        } else {
+            for (uint32_t k : indices) {
+                if (!expression.empty()) expression += " + ";
+                expression += terms[used[k]];
+            }
+        }
+    }
+    result.budgetExpired = budget.expired();
+    return result;
+}
@@ -0,0 +1,68 @@
+#ifndef MULTI_OUTPUT_SOLVER_HPP
+#define MULTI_OUTPUT_SOLVER_HPP
+
+#include "truth_table.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+using std::string;
+using std::vector;
+
+// Most outputs one MultiOutputSolver minimizes together; a prime's outputs are
+// kept as a bit set, and primes are generated for every combination of outputs
+// whose care sets overlap
+const int kMaxMultiOutputs = 16;
+
+// Shared cover of a bundle of functions over the same variables
+struct MultiOutputResult {
+    vector<char> variables;
+    vector<Cube> products;             // distinct product terms, sorted by term
+    vector<vector<uint32_t>> outputs;  // per output, indices into `products` of the terms it ORs
+    vector<string> expressions;        // per output, e.g. AB + C
+    size_t primeCount = 0;             // multi-output primes the cover was chosen from
+    size_t literalCount = 0;           // literals over the distinct products
+    size_t connectionCount = 0;        // product-to-output connections, i.e. OR gate inputs
+    bool provenOptimal = false;        // no shared cover has fewer products (then fewer literals)
+    size_t lowerBound = 0;             // no shared cover has fewer products; products.size() when proven, 0 if unknown
+    bool budgetExpired = false;        // the solve budget ran out; the cover is the best found by then
+};
+
+// Minimizes several equations at once so that outputs can share product terms.
+// All truth tables are built in one sweep over the table words, primes are
+// generated once per combination of outputs (each prime tagged with every
+// output whose on-set plus don't-cares contains it), and one exact covering
+// problem over every output's minterms picks the fewest distinct products.
+// Each output then keeps an irredundant subset of the chosen products.
+class MultiOutputSolver {
+public:
+    // Equations are written as for KMapSolver. Without a variable list the
+    // outputs range over the union of their variables.
+    explicit MultiOutputSolver(const vector<string>& equations);
+    MultiOutputSolver(const vector<string>& equations, const vector<char>& variables);
+
+    size_t getOutputCount() const { return onSets.size(); }
+    const vector<char>& getVariables() const { return variables; }
+
+    // Worker threads for truth tables and prime generation (0 = one per hardware thread)
+    void setThreadCount(int count);
+    int getThreadCount() const { return threadCount; }
+
+    // Bound the solve as KMapSolver::setSolveBudget() does (0 = no limit)
+    void setSolveBudget(uint64_t deadlineMs, uint64_t stepLimit = 0);
+
+    // Solve from scratch; the shared cover is self-checked against every output
+    MultiOutputResult solve() const;
+
+private:
+    vector<char> variables;
+    // Per output, the on-set and don't-care cubes over `variables`
+    vector<vector<Cube>> onSets, dontCareSets;
+    int threadCount = 1;
+    uint64_t deadlineMs = 0, stepLimit = 0;
+
+    void load(const vector<string>& equations, const vector<char>* expectedVariables);
+};
+
+#endif // MULTI_OUTPUT_SOLVER_HPP
@@ -0,0 +1,248 @@
+#include "npn_cache.hpp"
+#include <algorithm>
+
+// Most candidate transforms tried before a function is left uncached
+static const uint64_t kCanonicalBudget = 1024;
+
+static const uint64_t lowPatterns[6] = {
+    0xAAAAAAAAAAAAAAAAull,
+    0xCCCCCCCCCCCCCCCCull,
+    0xF0F0F0F0F0F0F0F0ull,
+    0xFF00FF00FF00FF00ull,
+    0xFFFF0000FFFF0000ull,
+    0xFFFFFFFF00000000ull
+};
+
+// t(x) -> t(x ^ e_var)
+static uint64_t flipVariable(uint64_t t, int var) {
+    int shift = 1 << var;
+    return ((t & lowPatterns[var]) >> shift) | ((t & ~lowPatterns[var]) << shift);
+}
+
+// Exchange variables i < j: minterms with x_i = 1, x_j = 0 trade places with
+// those with x_i = 0, x_j = 1
+static uint64_t swapVariables(uint64_t t, int i, int j) {
+    int shift = (1 << j) - (1 << i);
+    uint64_t moving = lowPatterns[i] & ~lowPatterns[j];
+    return (t & ~(moving | (moving << shift))) | ((t & moving) << shift) | ((t >> shift) & moving);
+}
+
+// f under the input part of the transform
+static uint64_t applyTransform(uint64_t t, int varCount, const NpnTransform& transform) {
+    for (int i = 0; i < varCount; i++) {
+        if ((transform.phase >> i) & 1) t = flipVariable(t, i);
+    }
+    // where[p]: original variable currently at position p
+    int where[kMaxNpnCacheVariables], position[kMaxNpnCacheVariables];
+    for (int i = 0; i < varCount; i++) where[i] = position[i] = i;
+    for (int p = 0; p < varCount; p++) {
+        int var = std::find(transform.perm, transform.perm + varCount, p) - transform.perm;
+        int from = position[var];
+        if (from == p) continue;
+        t = swapVariables(t, p, from);
+        int displaced = where[p];
+        where[from] = displaced;
+        position[displaced] = from;
+        where[p] = var;
+        position[var] = p;
+    }
+    return t;
+}
+
+namespace {
+
+// Tries every transform the cofactor signature leaves open and keeps the
+// smallest table
+class Canonicalizer {
+public:
+    Canonicalizer(int varCount) : varCount(varCount), full(variableMask(1 << varCount)) {}
+
+    // Queue the candidates of one output polarity; false once over budget
+    bool addPolarity(uint64_t t, bool negated) {
+        uint64_t phase = 0, freePhases = 0;
+        uint64_t signature[kMaxNpnCacheVariables];
+        for (int i = 0; i < varCount; i++) {
+            int ones = __builtin_popcountll(t & lowPatterns[i] & full);
+            int zeros = __builtin_popcountll(t & ~lowPatterns[i] & full);
+            if (ones < zeros) phase |= uint64_t(1) << i;
+            if (ones == zeros) freePhases |= uint64_t(1) << i;
+            // The larger cofactor decides, then the second-order counts break ties
+            uint64_t pairs = pairSignature(t & (ones < zeros ? ~lowPatterns[i] : lowPatterns[i]), i);
+            if (ones == zeros) pairs = std::max(pairs, pairSignature(t & ~lowPatterns[i], i));
+            signature[i] = (uint64_t(std::max(ones, zeros)) << 60) | pairs;
+        }
+
+        // Variables with larger signatures go first; equal ones form a group
+        int order[kMaxNpnCacheVariables];
+        for (int i = 0; i < varCount; i++) order[i] = i;
+        for (int k = 1; k < varCount; k++) {
+            for (int m = k; m > 0 && signature[order[m - 1]] < signature[order[m]]; m--) {
+                std::swap(order[m - 1], order[m]);
+            }
+        }
+        groupCount = 0;
+        uint64_t count = uint64_t(1) << __builtin_popcountll(freePhases);
+        for (int begin = 0, end; begin < varCount; begin = end) {
+            for (end = begin + 1; end < varCount && signature[order[end]] == signature[order[begin]]; end++) {
+                count *= end - begin + 1;
+            }
+            groupEnds[groupCount++] = end;
+        }
+        tried += count;
+        if (tried > kCanonicalBudget) return false;
+
+        for (uint64_t sub = 0;; sub = (sub - freePhases) & freePhases) {
+            permute(t, negated, phase ^ sub, order, 0);
+            if (sub == freePhases) break;
+        }
+        return true;
+    }
+
+    uint64_t best = ~uint64_t(0);
+    bool bestNegated = false;
+    NpnTransform transform{};
+
+private:
+    // How the larger cofactor `half` of variable `var` splits on each other
+    // variable: the (larger, smaller) count pairs, largest first, packed 12 bits
+    // each. Permuting variables or flipping their phases leaves it unchanged.
+    uint64_t pairSignature(uint64_t half, int var) const {
+        uint64_t pairs[kMaxNpnCacheVariables];
+        int count = 0;
+        for (int j = 0; j < varCount; j++) {
+            if (j == var) continue;
+            uint64_t a = __builtin_popcountll(half & lowPatterns[j] & full);
+            uint64_t b = __builtin_popcountll(half & ~lowPatterns[j] & full);
+            pairs[count++] = (std::max(a, b) << 6) | std::min(a, b);
+        }
+        for (int k = 1; k < count; k++) {
+            for (int m = k; m > 0 && pairs[m - 1] < pairs[m]; m--) std::swap(pairs[m - 1], pairs[m]);
+        }
+        uint64_t packed = 0;
+        for (int k = 0; k < count; k++) packed = (packed << 12) | pairs[k];
+        return packed;
+    }
+
+    void permute(uint64_t t, bool negated, uint64_t phase, int* order, int group) {
+        if (group == groupCount) {
+            NpnTransform candidate{};
+            candidate.phase = static_cast<uint8_t>(phase);
+            for (int p = 0; p < varCount; p++) candidate.perm[order[p]] = static_cast<uint8_t>(p);
+            uint64_t result = applyTransform(t, varCount, candidate);
+            if (result < best) {
+                best = result;
+                bestNegated = negated;
+                transform = candidate;
+            }
+            return;
+        }
+        int* begin = order + (group ? groupEnds[group - 1] : 0);
+        int* end = order + groupEnds[group];
+        int members[kMaxNpnCacheVariables];
+        std::copy(begin, end, members);
+        std::sort(begin, end);
+        do {
+            permute(t, negated, phase, order, group + 1);
+        } while (std::next_permutation(begin, end));
+        std::copy(members, members + (end - begin), begin);
+    }
+
+    int varCount;
+    uint64_t full;
+    uint64_t tried = 0;
+    int groupEnds[kMaxNpnCacheVariables]; // groups of tied variables, as ends of runs of the order
+    int groupCount = 0;
+};
+
+} // namespace
+
+bool npnCanonicalize(uint64_t function, int varCount, uint64_t& reached, NpnTransform& transform) {
+    Canonicalizer canonicalizer(varCount);
+    uint64_t full = variableMask(1 << varCount);
+    int ones = __builtin_popcountll(function & full), half = 1 << (varCount - 1);
+    // Fewer ones first; both polarities when balanced, preferring the original
+    if (ones <= half && !canonicalizer.addPolarity(function & full, false)) return false;
+    if (ones >= half && !canonicalizer.addPolarity(~function & full, true)) return false;
+    transform = canonicalizer.transform;
+    reached = canonicalizer.bestNegated ? ~canonicalizer.best & full : canonicalizer.best;
+    return true;
+}
+
+Cube npnMapCube(const Cube& cube, int varCount, const NpnTransform& transform) {
+    Cube mapped{0, 0};
+    for (int i = 0; i < varCount; i++) {
+        int p = transform.perm[i];
+        if (!((cube.mask >> p) & 1)) continue;
+        mapped.mask |= uint64_t(1) << i;
+        mapped.value |= (((cube.value >> p) ^ (transform.phase >> i)) & 1) << i;
+    }
+    return mapped;
+}
+
+NpnCoverCache::NpnCoverCache(size_t capacity)
+    : shardCapacity(std::max<size_t>(1, capacity / kShardCount)), hits(0), misses(0) {}
+
+void NpnCoverCache::getCover(uint64_t function, int varCount, const Solver& solve, CubeList& cover,
+                             bool& provenOptimal) {
+    NpnTransform transform;
+    uint64_t reached;
+    if (__builtin_popcountll(function) <= kNpnSparseMinterms ||
+        !npnCanonicalize(function, varCount, reached, transform)) {
+        solve(function, varCount, cover, provenOptimal);
+        return;
+    }
+
+    Key key{reached, varCount};
+    Shard& shard = shardOf(key);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto found = shard.index.find(key);
+        if (found != shard.index.end()) {
+            shard.order.splice(shard.order.begin(), shard.order, found->second);
+            for (const Cube& cube : found->second->cover) cover.push_back(npnMapCube(cube, varCount, transform));
+            provenOptimal = found->second->provenOptimal;
+            hits++;
+            return;
+        }
+    }
+
+    // Solve outside the lock; a concurrent miss on the same class just solves twice
+    misses++;
+    CubeList solved(cover.arena());
+    solve(reached, varCount, solved, provenOptimal);
+    Entry entry{key, vector<Cube>(solved.begin(), solved.end()), provenOptimal};
+    for (const Cube& cube : entry.cover) cover.push_back(npnMapCube(cube, varCount, transform));
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.index.count(key)) return;
+    shard.order.push_front(std::move(entry));
+    shard.index[key] = shard.order.begin();
+    if (shard.order.size() > shardCapacity) {
+        shard.index.erase(shard.order.back().key);
+        shard.order.pop_back();
+    }
+}
+
+size_t NpnCoverCache::size() const {
+    size_t total = 0;
+    for (const Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.order.size();
+    }
+    return total;
+}
+
+void NpnCoverCache::clear() {
+    for (Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.order.clear();
+        shard.index.clear();
+    }
+    hits = 0;
+    misses = 0;
+}
+
+NpnCoverCache& npnCoverCache() {
+    static NpnCoverCache cache;
+    return cache;
+}
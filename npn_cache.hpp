@@ -0,0 +1,97 @@
+#ifndef NPN_CACHE_HPP
+#define NPN_CACHE_HPP
+
+#include "truth_table.hpp"
+#include "cube_arena.hpp"
+#include <atomic>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+// Variable counts whose covers are cached by NPN class
+const int kMinNpnCacheVariables = 5;
+const int kMaxNpnCacheVariables = 6;
+
+// Functions with at most this many minterms are solved directly: their few
+// primes cover in less time than canonicalizing takes (see npn_cache_bench)
+const int kNpnSparseMinterms = 8;
+
+// Input negation and permutation relating a function f to its class
+// representative h: h(y) = f(x) with x_i = y_perm[i] ^ phase_i. A cube of h maps
+// back to a cube of f with the same literal count, so minimal covers carry over.
+struct NpnTransform {
+    uint8_t perm[kMaxNpnCacheVariables];
+    uint8_t phase;
+};
+
+// Representative of the NPN class of a function of up to 6 variables (its truth
+// table in the low 2^varCount bits): the smallest table reachable through input
+// negations, input permutations and output negation. Cofactor counts, refined by
+// how each cofactor splits on the other variables, fix most phases and the
+// variable order, so only choices they leave tied are tried; if
+// that exceeds a fixed budget (highly symmetric functions) this returns false.
+// Since a cover of ~f says nothing about f, `reached` is the representative with
+// the output negation undone, i.e. f under `transform` alone.
+bool npnCanonicalize(uint64_t function, int varCount, uint64_t& reached, NpnTransform& transform);
+
+// Cube of the representative mapped back to the original function
+Cube npnMapCube(const Cube& cube, int varCount, const NpnTransform& transform);
+
+// Bounded LRU cache of minimal covers of class representatives, shared by all
+// threads. The cache is split into shards, each with its own lock and LRU list.
+class NpnCoverCache {
+public:
+    // Appends a minimal cover of `reached` to `cover` and says whether it is proven minimal
+    using Solver = std::function<void(uint64_t reached, int varCount, CubeList& cover, bool& provenOptimal)>;
+
+    explicit NpnCoverCache(size_t capacity = size_t(1) << 16);
+
+    // Cover of the function, through its class representative when it has
+    // one: a hit maps the cached cover back, a miss solves the representative
+    // first. Sparse functions and those without a representative are solved
+    // directly. Hits and direct solves with a solver that stays in the arena
+    // of `cover` do not touch the heap.
+    void getCover(uint64_t function, int varCount, const Solver& solve, CubeList& cover, bool& provenOptimal);
+
+    uint64_t getHits() const { return hits; }
+    uint64_t getMisses() const { return misses; }
+    size_t size() const;
+    void clear();
+
+private:
+    struct Key {
+        uint64_t function;
+        int varCount;
+        bool operator==(const Key& other) const {
+            return function == other.function && varCount == other.varCount;
+        }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return std::hash<uint64_t>()(key.function * 0x9E3779B97F4A7C15ull + key.varCount);
+        }
+    };
+    struct Entry {
+        Key key;
+        vector<Cube> cover;
+        bool provenOptimal;
+    };
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> order; // most recently used first
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+    };
+    static const size_t kShardCount = 16;
+
+    Shard& shardOf(const Key& key) { return shards[KeyHash()(key) % kShardCount]; }
+
+    Shard shards[kShardCount];
+    size_t shardCapacity;
+    std::atomic<uint64_t> hits, misses;
+};
+
+// Cache shared by every solver in the process
+NpnCoverCache& npnCoverCache();
+
+#endif // NPN_CACHE_HPP
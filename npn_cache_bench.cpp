@@ -0,0 +1,96 @@
+// Microbenchmark of the NPN cover cache: times solving 5- and 6-variable
+// functions directly with the K-map kernels against going through
+// NpnCoverCache::getCover(), cold (every class a miss) and warm (every class
+// already cached), for sparse functions and for random ones.
+//
+// Usage: npn_cache_bench [functions per workload, default 20000]
+#include "npn_cache.hpp"
+#include "kmap_kernels.hpp"
+#include "quine_mccluskey.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+namespace {
+
+// The solver the K-map engine hands the cache
+void kernelCover(uint64_t function, int varCount, CubeList& cover, bool& provenOptimal) {
+    CubeList primes(cover.arena());
+    findKMapPrimes(function, varCount, primes);
+    selectCover(primes.data(), primes.size(), function, varCount, cover, &provenOptimal);
+}
+
+// Functions with `ones` random minterms, or uniformly random ones when `ones` is 0
+vector<uint64_t> workload(int varCount, int ones, size_t count, std::mt19937_64& random) {
+    uint64_t full = variableMask(1 << varCount);
+    vector<uint64_t> functions;
+    while (functions.size() < count) {
+        uint64_t t = 0;
+        if (ones == 0) {
+            t = random() & full;
+        } else {
+            while (__builtin_popcountll(t) < ones) t |= uint64_t(1) << (random() % (1 << varCount));
+        }
+        functions.push_back(t);
+    }
+    return functions;
+}
+
+// Microseconds per function
+template <typename Solve>
+double timeEach(const vector<uint64_t>& functions, Solve&& solve) {
+    using Clock = std::chrono::steady_clock;
+    size_t sink = 0;
+    Clock::time_point start = Clock::now();
+    for (uint64_t function : functions) {
+        CubeArenaScope scope;
+        CubeList cover(scope.arena);
+        solve(function, cover);
+        sink += cover.size();
+    }
+    double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / functions.size();
+    // Keep the results observable so the solves are not optimized away
+    if (sink == size_t(-1)) std::puts("");
+    return us;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    long count = argc > 1 ? std::atol(argv[1]) : 20000;
+    if (count <= 0) {
+        std::fprintf(stderr, "Usage: %s [functions per workload]\n", argv[0]);
+        return 1;
+    }
+    struct Workload {
+        const char* name;
+        int varCount, ones;
+    };
+    const Workload workloads[] = {
+        {"5 vars, 4 ones", 5, 4},
+        {"5 vars, random", 5, 0},
+        {"6 vars, 5 ones", 6, 5},
+        {"6 vars, 12 ones", 6, 12},
+        {"6 vars, random", 6, 0},
+    };
+
+    std::printf("%-18s %10s %10s %10s\n", "workload", "direct us", "cold us", "warm us");
+    std::mt19937_64 random(12345);
+    for (const Workload& w : workloads) {
+        vector<uint64_t> functions = workload(w.varCount, w.ones, count, random);
+        double direct = timeEach(functions, [&](uint64_t function, CubeList& cover) {
+            bool proven;
+            kernelCover(function, w.varCount, cover, proven);
+        });
+        NpnCoverCache cache(size_t(1) << 20);
+        auto cached = [&](uint64_t function, CubeList& cover) {
+            bool proven;
+            cache.getCover(function, w.varCount, kernelCover, cover, proven);
+        };
+        double cold = timeEach(functions, cached);
+        double warm = timeEach(functions, cached);
+        std::printf("%-18s %10.2f %10.2f %10.2f\n", w.name, direct, cold, warm);
+    }
+    return 0;
+}
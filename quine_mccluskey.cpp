@@ -0,0 +1,661 @@
+#include "quine_mccluskey.hpp"
+#include "cover_solver.hpp"
+#include "task_scheduler.hpp"
+#include "cube_arena.hpp"
+#include <algorithm>
+#include <limits>
+
+// Merge every pair (a in lo, b in hi) with the same care mask whose values differ
+// in exactly one bit. Both runs are sorted by (mask, value); for a fixed mask
+// and bit, a -> a ^ bit is monotone over the values with that bit clear, so each
+// bit is a binary search for the first partner and then a single two-pointer
+// pass. A merged cube is reachable through each of its free bits, so it is only
+// emitted through the highest one; the other merges just mark their inputs as
+// non-prime. That makes every cube of the next column unique without any
+// deduplication. Used hi cubes are reported as indices into `hi`, since the hi
+// windows of neighbouring tasks overlap.
+static void mergeBuckets(const Cube* lo, size_t loSize, const Cube* hi, size_t hiSize, uint64_t full,
+                         char* usedLo, vector<uint32_t>& usedHi, vector<Cube>& out) {
+    size_t i = 0, j = 0;
+    while (i < loSize && j < hiSize) {
+        uint64_t mask = lo[i].mask;
+        if (hi[j].mask < mask) { j++; continue; }
+        if (hi[j].mask > mask) { i++; continue; }
+        
+        size_t loEnd = i, hiEnd = j;
+        while (loEnd < loSize && lo[loEnd].mask == mask) loEnd++;
+        while (hiEnd < hiSize && hi[hiEnd].mask == mask) hiEnd++;
+        
+        uint64_t freeBits = ~mask & full;
+        for (uint64_t bits = mask; bits; bits &= bits - 1) {
+            uint64_t bit = bits & (~bits + 1);
+            bool emit = bit > freeBits;
+            size_t a = i;
+            while (a < loEnd && (lo[a].value & bit)) a++;
+            if (a == loEnd) continue;
+            size_t b = std::lower_bound(hi + j, hi + hiEnd, Cube{mask, lo[a].value ^ bit}) - hi;
+            for (; a < loEnd; a++) {
+                if (lo[a].value & bit) continue;
+                uint64_t partner = lo[a].value ^ bit;
+                while (b < hiEnd && hi[b].value < partner) b++;
+                if (b == hiEnd) break;
+                if (hi[b].value == partner) {
+                    if (emit) out.push_back({mask & ~bit, lo[a].value});
+                    usedLo[a] = 1;
+                    usedHi.push_back(static_cast<uint32_t>(b));
+                }
+            }
+        }
+        i = loEnd;
+        j = hiEnd;
+    }
+}
+
+// Lo implicants per merge task; a bucket pair splits into chunks of this size
+// wherever the mask runs fall, so one long run cannot become one huge task
+static const size_t kMergeChunk = 4096;
+
+namespace {
+
+// Cubes lo[loBegin, loEnd) of bucket k against the cubes hi[hiBegin, hiEnd) of
+// bucket k + 1 that can be their partners
+struct MergeTask {
+    int bucket;
+    size_t loBegin, loEnd, hiBegin, hiEnd;
+};
+
+} // namespace
+
+vector<Cube> findPrimeImplicants(const TruthTable& onSet, int threadCount, SolveBudget* budget) {
+    int varCount = onSet.getVariableCount();
+    uint64_t full = variableMask(varCount);
+
+    // Column 0: one fully specified implicant per minterm
+    vector<Cube> level;
+    const vector<uint64_t>& words = onSet.words();
+    for (size_t w = 0; w < words.size(); w++) {
+        for (uint64_t bits = words[w]; bits; bits &= bits - 1) {
+            level.push_back({full, (uint64_t(w) << 6) | __builtin_ctzll(bits)});
+        }
+    }
+
+    vector<Cube> primes;
+    vector<vector<Cube>> buckets(varCount + 1);
+    // A bucket is the hi side of one merge and the lo side of the next; separate
+    // flags keep the two concurrent merges from writing the same bytes. Lo chunks
+    // are disjoint, so tasks set usedAsLo directly; their hi windows overlap, so
+    // usedAsHi is only filled from each task's list once the merges are done.
+    vector<vector<char>> usedAsLo(varCount + 1), usedAsHi(varCount + 1);
+    while (!level.empty()) {
+        if (budget && !budget->spend()) break;
+        // Group implicants by the number of ones in their value
+        for (auto& bucket : buckets) bucket.clear();
+        for (const Cube& c : level) buckets[__builtin_popcountll(c.value)].push_back(c);
+        runTasks(varCount + 1, threadCount, [&](size_t k) {
+            std::sort(buckets[k].begin(), buckets[k].end());
+            usedAsLo[k].assign(buckets[k].size(), 0);
+            usedAsHi[k].assign(buckets[k].size(), 0);
+        });
+
+        // Only buckets k and k+1 can hold a pair that differs in exactly one bit;
+        // every pair is independent, and big pairs split into lo chunks. A
+        // chunk's partners lie between its first cube and its last cube with
+        // the highest bit of its mask added.
+        vector<MergeTask> tasks;
+        for (int k = 0; k < varCount; k++) {
+            const vector<Cube>& lo = buckets[k];
+            const vector<Cube>& hi = buckets[k + 1];
+            if (lo.empty() || hi.empty()) continue;
+            for (size_t begin = 0; begin < lo.size(); begin += kMergeChunk) {
+                size_t end = std::min(begin + kMergeChunk, lo.size());
+                const Cube& first = lo[begin];
+                const Cube& last = lo[end - 1];
+                uint64_t reach = last.mask ? uint64_t(1) << (63 - __builtin_clzll(last.mask)) : 0;
+                auto hiBegin = std::lower_bound(hi.begin(), hi.end(), first);
+                auto hiEnd = std::upper_bound(hiBegin, hi.end(), Cube{last.mask, last.value + reach});
+                tasks.push_back({k, begin, end, size_t(hiBegin - hi.begin()), size_t(hiEnd - hi.begin())});
+            }
+        }
+        std::stable_sort(tasks.begin(), tasks.end(), [](const MergeTask& a, const MergeTask& b) {
+            return (a.loEnd - a.loBegin) + (a.hiEnd - a.hiBegin) > (b.loEnd - b.loBegin) + (b.hiEnd - b.hiBegin);
+        });
+
+        vector<vector<Cube>> merged(tasks.size());
+        vector<vector<uint32_t>> usedHi(tasks.size());
+        runTasks(tasks.size(), threadCount, [&](size_t t) {
+            if (budget && !budget->spend(0)) return;
+            const MergeTask& task = tasks[t];
+            const vector<Cube>& lo = buckets[task.bucket];
+            const vector<Cube>& hi = buckets[task.bucket + 1];
+            mergeBuckets(lo.data() + task.loBegin, task.loEnd - task.loBegin,
+                         hi.data() + task.hiBegin, task.hiEnd - task.hiBegin, full,
+                         usedAsLo[task.bucket].data() + task.loBegin, usedHi[t], merged[t]);
+        });
+        if (budget && budget->expired()) break;
+        // Each hi bucket is filled by one task from the lists of the merges into it
+        runTasks(varCount + 1, threadCount, [&](size_t k) {
+            for (size_t t = 0; t < tasks.size(); t++) {
+                if (size_t(tasks[t].bucket + 1) != k) continue;
+                for (uint32_t b : usedHi[t]) usedAsHi[k][tasks[t].hiBegin + b] = 1;
+            }
+        });
+
+        // Anything that merged with nothing is prime
+        for (int k = 0; k <= varCount; k++) {
+            for (size_t i = 0; i < buckets[k].size(); i++) {
+                if (!usedAsLo[k][i] && !usedAsHi[k][i]) primes.push_back(buckets[k][i]);
+            }
+        }
+
+        vector<Cube> next;
+        size_t total = 0;
+        for (const auto& part : merged) total += part.size();
+        next.reserve(total);
+        for (const auto& part : merged) next.insert(next.end(), part.begin(), part.end());
+        level.swap(next);
+    }
+    // Only left when out of budget: the unmerged column still covers the rest
+    primes.insert(primes.end(), level.begin(), level.end());
+    return primes;
+}
+
+vector<Cube> selectCover(const vector<Cube>& primes, const TruthTable& onSet, bool* provenOptimal,
+                         size_t* lowerBound, SolveBudget* budget) {
+    return selectCover(primes.data(), primes.size(), onSet, provenOptimal, lowerBound, budget);
+}
+
+vector<Cube> selectCover(const Cube* primes, size_t primeCount, const TruthTable& onSet, bool* provenOptimal,
+                         size_t* lowerBound, SolveBudget* budget) {
+    int varCount = onSet.getVariableCount();
+    if (varCount <= kMaxWordVariables) {
+        CubeArenaScope scope;
+        CubeList cover(scope.arena);
+        selectCover(primes, primeCount, onSet.words()[0], varCount, cover, provenOptimal, lowerBound, budget);
+        return vector<Cube>(cover.begin(), cover.end());
+    }
+    uint64_t full = variableMask(varCount);
+    const vector<uint64_t>& words = onSet.words();
+
+    // Dense index of each on-set minterm: ones in earlier words plus ones below it
+    vector<uint32_t> prefix(words.size() + 1, 0);
+    for (size_t w = 0; w < words.size(); w++) {
+        prefix[w + 1] = prefix[w] + __builtin_popcountll(words[w]);
+    }
+    uint32_t mintermCount = prefix[words.size()];
+    auto rank = [&](uint64_t m) {
+        uint64_t below = words[m >> 6] & ((uint64_t(1) << (m & 63)) - 1);
+        return prefix[m >> 6] + static_cast<uint32_t>(__builtin_popcountll(below));
+    };
+    // Primes may reach into don't-cares; only on-set minterms are rows
+    auto forEachMinterm = [&](const Cube& cube, auto&& body) {
+        uint64_t free = ~cube.mask & full;
+        uint64_t sub = 0;
+        do {
+            uint64_t m = cube.value | sub;
+            if ((words[m >> 6] >> (m & 63)) & 1) body(m);
+            sub = (sub - free) & free;
+        } while (sub != 0);
+    };
+
+    // Out of budget before covering starts: take primes largest first while they
+    // still reach an uncovered minterm, without building the covering table
+    if (budget && budget->expired()) {
+        vector<uint32_t> order(primeCount);
+        for (uint32_t p = 0; p < primeCount; p++) order[p] = p;
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return __builtin_popcountll(primes[a].mask) < __builtin_popcountll(primes[b].mask);
+        });
+        vector<Cube> cover;
+        vector<char> covered(mintermCount, 0);
+        uint32_t left = mintermCount;
+        for (size_t i = 0; i < order.size() && left > 0; i++) {
+            const Cube& prime = primes[order[i]];
+            bool useful = false;
+            forEachMinterm(prime, [&](uint64_t m) { useful = useful || !covered[rank(m)]; });
+            if (!useful) continue;
+            cover.push_back(prime);
+            forEachMinterm(prime, [&](uint64_t m) {
+                if (!covered[rank(m)]) left--;
+                covered[rank(m)] = 1;
+            });
+        }
+        if (provenOptimal) *provenOptimal = false;
+        if (lowerBound) *lowerBound = 0;
+        return cover;
+    }
+
+    // Minterm -> covering primes, in CSR layout
+    vector<uint32_t> offsets(mintermCount + 1, 0);
+    for (size_t p = 0; p < primeCount; p++) {
+        forEachMinterm(primes[p], [&](uint64_t m) { offsets[rank(m) + 1]++; });
+    }
+    for (uint32_t i = 0; i < mintermCount; i++) offsets[i + 1] += offsets[i];
+    vector<uint32_t> coverers(offsets[mintermCount]);
+    vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (uint32_t p = 0; p < primeCount; p++) {
+        forEachMinterm(primes[p], [&](uint64_t m) { coverers[fill[rank(m)]++] = p; });
+    }
+
+    vector<Cube> cover;
+    vector<char> chosen(primeCount, 0);
+    vector<char> covered(mintermCount, 0);
+    auto take = [&](uint32_t p) {
+        chosen[p] = 1;
+        cover.push_back(primes[p]);
+        forEachMinterm(primes[p], [&](uint64_t m) { covered[rank(m)] = 1; });
+    };
+
+    // Essential primes: the only prime covering some minterm
+    for (uint32_t r = 0; r < mintermCount; r++) {
+        if (offsets[r + 1] - offsets[r] == 1 && !chosen[coverers[offsets[r]]]) {
+            take(coverers[offsets[r]]);
+        }
+    }
+
+    // The uncovered minterms form the cyclic core; identical rows collapse into one
+    vector<vector<uint32_t>> rows;
+    for (uint32_t r = 0; r < mintermCount; r++) {
+        if (!covered[r]) rows.emplace_back(coverers.begin() + offsets[r], coverers.begin() + offsets[r + 1]);
+    }
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    // Only primes that appear in the core become columns; fewer cubes first,
+    // then fewer literals
+    vector<int32_t> columnOf(primeCount, -1);
+    vector<uint32_t> columnPrime;
+    vector<uint64_t> costs;
+    for (auto& row : rows) {
+        for (uint32_t& p : row) {
+            if (columnOf[p] < 0) {
+                columnOf[p] = static_cast<int32_t>(columnPrime.size());
+                columnPrime.push_back(p);
+                costs.push_back((uint64_t(1) << 32) + __builtin_popcountll(primes[p].mask));
+            }
+            p = static_cast<uint32_t>(columnOf[p]);
+        }
+    }
+
+    CoverSolution solution = solveUnateCover(rows, costs, kDefaultCoverNodeLimit, budget);
+    // Every column costs one cube in the high word
+    if (lowerBound) *lowerBound = cover.size() + (solution.lowerBound >> 32);
+    for (uint32_t c : solution.columns) cover.push_back(primes[columnPrime[c]]);
+    if (provenOptimal) *provenOptimal = solution.provenOptimal;
+    return cover;
+}
+
+namespace {
+
+// Exact minimum-cost cover of the minterms of a single-word function. Column c
+// covers the minterms cells[c], so rows are bits and every set operation is
+// one word. A column set aside for the rest of a subtree has its cells cleared
+// and restored afterwards. All scratch comes from the arena.
+class WordCoverSearch {
+public:
+    WordCoverSearch(uint64_t* cells, const uint64_t* costs, uint32_t columnCount, CubeArena& arena,
+                    SolveBudget* budget)
+        : best(arena.allocateArray<uint32_t>(64)), cells(cells), costs(costs), columnCount(columnCount),
+          arena(arena), budget(budget), chosen(arena.allocateArray<uint32_t>(64)) {}
+
+    // Cheapest cover of `rows`: best[0, bestCount); complete unless cut off
+    void run(uint64_t rows) {
+        greedy(rows);
+        rootBound = lowerBound(rows);
+        search(rows, 0, 0);
+    }
+
+    uint32_t* best;
+    uint32_t bestCount = 0;
+    uint64_t bestCost = kNoCover;
+    uint64_t rootBound = 0;
+    bool complete = true;
+
+private:
+    static const uint64_t kNoCover = std::numeric_limits<uint64_t>::max();
+
+    // Most newly covered minterms first, then the cheaper column; the initial upper bound
+    void greedy(uint64_t rows) {
+        uint64_t cost = 0;
+        uint32_t count = 0;
+        while (rows) {
+            uint32_t pick = columnCount;
+            int pickGain = 0;
+            for (uint32_t c = 0; c < columnCount; c++) {
+                int gain = __builtin_popcountll(cells[c] & rows);
+                if (gain > pickGain || (gain == pickGain && gain > 0 && costs[c] < costs[pick])) {
+                    pick = c;
+                    pickGain = gain;
+                }
+            }
+            if (pick == columnCount) return; // uncoverable minterm
+            best[count++] = pick;
+            cost += costs[pick];
+            rows &= ~cells[pick];
+        }
+        bestCount = count;
+        bestCost = cost;
+    }
+
+    // Minterms that share no column each need their own: a maximal set of them,
+    // each charged its cheapest column. kNoCover when some minterm has no column.
+    uint64_t lowerBound(uint64_t rows) const {
+        uint64_t bound = 0;
+        while (rows) {
+            uint64_t row = rows & (~rows + 1);
+            uint64_t reach = 0, cheapest = kNoCover;
+            for (uint32_t c = 0; c < columnCount; c++) {
+                if (!(cells[c] & row)) continue;
+                reach |= cells[c];
+                cheapest = std::min(cheapest, costs[c]);
+            }
+            if (!reach) return kNoCover;
+            bound += cheapest;
+            rows &= ~reach;
+        }
+        return bound;
+    }
+
+    void search(uint64_t rows, uint64_t cost, uint32_t depth) {
+        if (!rows) {
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestCount = depth;
+                std::copy(chosen, chosen + depth, best);
+            }
+            return;
+        }
+        uint64_t bound = lowerBound(rows);
+        if (bound == kNoCover || cost + bound >= bestCost) return;
+        if (++nodes > kDefaultCoverNodeLimit || (budget && !budget->spend())) {
+            complete = false;
+            return;
+        }
+
+        // Branch on the minterm with the fewest columns, widest columns first
+        int degree[64] = {0};
+        for (uint32_t c = 0; c < columnCount; c++) {
+            for (uint64_t bits = cells[c] & rows; bits; bits &= bits - 1) degree[__builtin_ctzll(bits)]++;
+        }
+        int pivot = __builtin_ctzll(rows);
+        for (uint64_t bits = rows; bits; bits &= bits - 1) {
+            if (degree[__builtin_ctzll(bits)] < degree[pivot]) pivot = __builtin_ctzll(bits);
+        }
+        CubeArena::Mark mark = arena.mark();
+        uint32_t* choices = arena.allocateArray<uint32_t>(degree[pivot]);
+        uint64_t* saved = arena.allocateArray<uint64_t>(degree[pivot]);
+        uint32_t choiceCount = 0;
+        for (uint32_t c = 0; c < columnCount; c++) {
+            if ((cells[c] >> pivot) & 1) choices[choiceCount++] = c;
+        }
+        std::sort(choices, choices + choiceCount, [&](uint32_t a, uint32_t b) {
+            int gainA = __builtin_popcountll(cells[a] & rows), gainB = __builtin_popcountll(cells[b] & rows);
+            return gainA != gainB ? gainA > gainB : a < b;
+        });
+
+        // Once a column's subtree is explored, later siblings exclude it
+        uint32_t explored = 0;
+        while (explored < choiceCount && complete) {
+            uint32_t c = choices[explored];
+            chosen[depth] = c;
+            search(rows & ~cells[c], cost + costs[c], depth + 1);
+            saved[explored++] = cells[c];
+            cells[c] = 0;
+        }
+        for (uint32_t i = 0; i < explored; i++) cells[choices[i]] = saved[i];
+        arena.rewind(mark);
+    }
+
+    uint64_t* cells;
+    const uint64_t* costs;
+    uint32_t columnCount;
+    CubeArena& arena;
+    SolveBudget* budget;
+    uint32_t* chosen;
+    size_t nodes = 0;
+};
+
+} // namespace
+
+void selectCover(const Cube* primes, size_t primeCount, uint64_t onSet, int varCount, CubeList& cover,
+                 bool* provenOptimal, size_t* lowerBound, SolveBudget* budget) {
+    CubeArena& arena = cover.arena();
+    onSet &= variableMask(1 << varCount);
+    uint64_t* cells = arena.allocateArray<uint64_t>(primeCount);
+    for (size_t p = 0; p < primeCount; p++) cells[p] = cubeWordPattern(primes[p]) & onSet;
+
+    // Out of budget before covering starts: take primes largest first while they
+    // still reach an uncovered minterm
+    if (budget && budget->expired()) {
+        uint64_t rows = onSet;
+        for (int literals = 0; literals <= varCount && rows; literals++) {
+            for (size_t p = 0; p < primeCount && rows; p++) {
+                if (__builtin_popcountll(primes[p].mask) != literals || !(cells[p] & rows)) continue;
+                cover.push_back(primes[p]);
+                rows &= ~cells[p];
+            }
+        }
+        if (provenOptimal) *provenOptimal = false;
+        if (lowerBound) *lowerBound = 0;
+        return;
+    }
+
+    // Essential primes: the only prime covering some minterm
+    uint64_t once = 0, twice = 0;
+    for (size_t p = 0; p < primeCount; p++) {
+        twice |= once & cells[p];
+        once |= cells[p];
+    }
+    uint64_t rows = onSet;
+    size_t essentialCount = 0;
+    for (size_t p = 0; p < primeCount; p++) {
+        if (!(cells[p] & once & ~twice)) continue;
+        cover.push_back(primes[p]);
+        rows &= ~cells[p];
+        essentialCount++;
+    }
+
+    // The rest is the cyclic core. Columns are the primes that reach it, less
+    // those another column covers at no greater cost: fewer cubes first, then
+    // fewer literals.
+    uint32_t* columnPrime = arena.allocateArray<uint32_t>(primeCount);
+    uint64_t* costs = arena.allocateArray<uint64_t>(primeCount);
+    uint32_t columnCount = 0;
+    for (size_t p = 0; p < primeCount && rows; p++) {
+        if (!(cells[p] & rows)) continue;
+        cells[columnCount] = cells[p] & rows;
+        costs[columnCount] = (uint64_t(1) << 32) + __builtin_popcountll(primes[p].mask);
+        columnPrime[columnCount++] = static_cast<uint32_t>(p);
+    }
+    uint32_t kept = 0;
+    for (uint32_t c = 0; c < columnCount; c++) {
+        bool dominated = false;
+        for (uint32_t d = 0; d < columnCount && !dominated; d++) {
+            if (d == c || (cells[c] & ~cells[d]) || costs[d] > costs[c]) continue;
+            // Equal columns: the first one stays
+            dominated = cells[d] != cells[c] || costs[d] < costs[c] || d < c;
+        }
+        if (dominated) continue;
+        cells[kept] = cells[c];
+        costs[kept] = costs[c];
+        columnPrime[kept++] = columnPrime[c];
+    }
+
+    WordCoverSearch search(cells, costs, kept, arena, budget);
+    search.run(rows);
+    for (uint32_t i = 0; i < search.bestCount; i++) cover.push_back(primes[columnPrime[search.best[i]]]);
+    // Every column costs one cube in the high word
+    uint64_t coreBound = search.complete ? search.bestCost : std::min(search.rootBound, search.bestCost);
+    if (lowerBound) *lowerBound = essentialCount + (coreBound >> 32);
+    if (provenOptimal) *provenOptimal = search.complete;
+}
+
+void findEssentialPrimes(const Cube* primes, size_t primeCount, uint64_t onSet, int varCount,
+                         CubeList& essentials) {
+    onSet &= variableMask(1 << varCount);
+    uint64_t once = 0, twice = 0;
+    for (size_t p = 0; p < primeCount; p++) {
+        uint64_t cells = cubeWordPattern(primes[p]) & onSet;
+        twice |= once & cells;
+        once |= cells;
+    }
+    for (size_t p = 0; p < primeCount; p++) {
+        if (cubeWordPattern(primes[p]) & onSet & once & ~twice) essentials.push_back(primes[p]);
+    }
+}
+
+vector<Cube> findEssentialPrimes(const Cube* primes, size_t primeCount, const TruthTable& onSet) {
+    if (onSet.getVariableCount() <= kMaxWordVariables) {
+        CubeArenaScope scope;
+        CubeList essentials(scope.arena);
+        findEssentialPrimes(primes, primeCount, onSet.words()[0], onSet.getVariableCount(), essentials);
+        return vector<Cube>(essentials.begin(), essentials.end());
+    }
+    auto forEachWord = [&](const Cube& cube, auto&& body) { forEachCubeWord(cube, onSet, body); };
+
+    // Minterms covered by at least one and by at least two primes
+    vector<uint64_t> once(onSet.wordCount(), 0), twice(onSet.wordCount(), 0);
+    for (size_t p = 0; p < primeCount; p++) {
+        forEachWord(primes[p], [&](uint64_t w, uint64_t pattern) {
+            twice[w] |= once[w] & pattern;
+            once[w] |= pattern;
+        });
+    }
+    vector<Cube> essentials;
+    for (size_t p = 0; p < primeCount; p++) {
+        bool essential = false;
+        forEachWord(primes[p], [&](uint64_t w, uint64_t pattern) {
+            essential |= (pattern & once[w] & ~twice[w] & onSet.words()[w]) != 0;
+        });
+        if (essential) essentials.push_back(primes[p]);
+    }
+    return essentials;
+}
+
+// Above this share of the on-set, a repair regenerates the primes outright
+static const uint64_t kRepairRegionDivisor = 16;
+
+vector<Cube> repairPrimeImplicants(const vector<Cube>& oldPrimes, const TruthTable& oldOnSet,
+                                   const TruthTable& onSet) {
+    // Minterms gained by the edit
+    TruthTable region(onSet.getVariableCount());
+    vector<uint64_t>& regionWords = region.words();
+    for (size_t w = 0; w < regionWords.size(); w++) {
+        regionWords[w] = onSet.words()[w] & ~oldOnSet.words()[w];
+    }
+    bool gained = region.count() > 0;
+
+    // An old prime that lost a minterm is gone, and its remaining minterms may
+    // lie in new, smaller primes. One that can grow now lies in a new prime
+    // through a gained minterm. Either way the new primes touch the region.
+    vector<Cube> primes;
+    for (const Cube& prime : oldPrimes) {
+        if (!onSet.containsCube(prime)) {
+            forEachCubeWord(prime, onSet, [&](uint64_t w, uint64_t pattern) { regionWords[w] |= pattern; });
+            continue;
+        }
+        bool grows = false;
+        for (uint64_t bits = prime.mask; gained && bits && !grows; bits &= bits - 1) {
+            uint64_t bit = bits & (~bits + 1);
+            grows = onSet.containsCube({prime.mask & ~bit, prime.value & ~bit});
+        }
+        if (!grows) primes.push_back(prime);
+    }
+    for (size_t w = 0; w < regionWords.size(); w++) regionWords[w] &= onSet.words()[w];
+    if (region.count() * kRepairRegionDivisor > onSet.count()) return findPrimeImplicants(onSet);
+
+    // Grow every region minterm one variable at a time; a cube that cannot
+    // grow is prime. Cubes of one column share a literal count, so sorting
+    // removes the duplicates reached from different minterms.
+    uint64_t full = variableMask(onSet.getVariableCount());
+    vector<Cube> level, next;
+    for (size_t w = 0; w < regionWords.size(); w++) {
+        for (uint64_t bits = regionWords[w]; bits; bits &= bits - 1) {
+            level.push_back({full, (uint64_t(w) << 6) | __builtin_ctzll(bits)});
+        }
+    }
+    while (!level.empty()) {
+        next.clear();
+        for (const Cube& cube : level) {
+            bool prime = true;
+            for (uint64_t bits = cube.mask; bits; bits &= bits - 1) {
+                uint64_t bit = bits & (~bits + 1);
+                Cube grown{cube.mask & ~bit, cube.value & ~bit};
+                if (onSet.containsCube(grown)) {
+                    next.push_back(grown);
+                    prime = false;
+                }
+            }
+            if (prime) primes.push_back(cube);
+        }
+        std::sort(next.begin(), next.end());
+        next.erase(std::unique(next.begin(), next.end()), next.end());
+        level.swap(next);
+    }
+
+    // Kept primes touching the region were found again
+    std::sort(primes.begin(), primes.end());
+    primes.erase(std::unique(primes.begin(), primes.end()), primes.end());
+    return primes;
+}
+
+vector<Cube> repairCover(const vector<Cube>& oldCover, const vector<Cube>& primes, const TruthTable& onSet,
+                         SolveBudget* budget) {
+    vector<Cube> sortedPrimes(primes);
+    std::sort(sortedPrimes.begin(), sortedPrimes.end());
+    vector<Cube> cover;
+    for (const Cube& cube : oldCover) {
+        if (std::binary_search(sortedPrimes.begin(), sortedPrimes.end(), cube)) cover.push_back(cube);
+    }
+
+    // Minterms the kept cubes no longer cover, densely ranked
+    TruthTable residual(onSet.getVariableCount());
+    rasterizeCubes(cover, residual);
+    vector<uint64_t>& words = residual.words();
+    vector<uint32_t> prefix(words.size() + 1, 0);
+    for (size_t w = 0; w < words.size(); w++) {
+        words[w] = onSet.words()[w] & ~words[w];
+        prefix[w + 1] = prefix[w] + __builtin_popcountll(words[w]);
+    }
+
+    if (prefix[words.size()] > 0) {
+        // Exact minimum cover of the residual by the primes that reach it
+        vector<vector<uint32_t>> rows(prefix[words.size()]);
+        vector<Cube> columns;
+        vector<uint64_t> costs;
+        for (const Cube& prime : primes) {
+            bool used = false;
+            forEachCubeWord(prime, residual, [&](uint64_t w, uint64_t pattern) {
+                for (uint64_t bits = pattern & words[w]; bits; bits &= bits - 1) {
+                    uint64_t below = words[w] & ((uint64_t(1) << __builtin_ctzll(bits)) - 1);
+                    rows[prefix[w] + __builtin_popcountll(below)].push_back(static_cast<uint32_t>(columns.size()));
+                    used = true;
+                }
+            });
+            if (used) {
+                columns.push_back(prime);
+                costs.push_back((uint64_t(1) << 32) + __builtin_popcountll(prime.mask));
+            }
+        }
+        std::sort(rows.begin(), rows.end());
+        rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+        for (uint32_t c : solveUnateCover(rows, costs, kDefaultCoverNodeLimit, budget).columns) {
+            cover.push_back(columns[c]);
+        }
+    }
+
+    // Drop kept cubes the new ones made redundant, most literals first
+    for (;;) {
+        vector<Cube> essentials = findEssentialPrimes(cover.data(), cover.size(), onSet);
+        if (essentials.size() == cover.size()) break;
+        std::sort(essentials.begin(), essentials.end());
+        auto redundant = cover.end();
+        for (auto it = cover.begin(); it != cover.end(); ++it) {
+            if (std::binary_search(essentials.begin(), essentials.end(), *it)) continue;
+            if (redundant == cover.end() || __builtin_popcountll(it->mask) > __builtin_popcountll(redundant->mask)) {
+                redundant = it;
+            }
+        }
+        cover.erase(redundant);
+    }
+    return cover;
+}
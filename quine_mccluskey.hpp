@@ -0,0 +1,62 @@
+#ifndef QUINE_MCCLUSKEY_HPP
+#define QUINE_MCCLUSKEY_HPP
+
+#include "truth_table.hpp"
+
+class SolveBudget;
+class CubeList;
+
+// Tabular (Quine-McCluskey) minimization over bit-packed cubes. Implicants are
+// (care mask, value) word pairs grouped by the popcount of their value; two
+// implicants merge when they share a care mask and their values differ in a
+// single bit.
+
+// All prime implicants of the function whose on-set is `onSet`. Bucket sorting
+// and the bucket-pair merges of each column run on up to `threadCount` threads
+// (0 = one per hardware thread) under a work-stealing scheduler. With
+// don't-cares, pass the on-set plus don't-cares so primes can grow through them.
+// Each column spends one step of `budget`; once it runs out, the implicants of
+// the current column are returned with the primes found so far. Those are not
+// all prime, but still cover the on-set.
+vector<Cube> findPrimeImplicants(const TruthTable& onSet, int threadCount = 1, SolveBudget* budget = nullptr);
+
+// Essential primes first, then an exact minimum cover of the remaining minterms
+// (fewest cubes, then fewest literals). Primes may extend into don't-cares
+// outside `onSet`; only its minterms are covered. `provenOptimal` reports
+// whether the covering search finished within its node limit and `budget`;
+// `lowerBound` receives a cube count no cover of `onSet` by these primes beats.
+vector<Cube> selectCover(const vector<Cube>& primes, const TruthTable& onSet, bool* provenOptimal = nullptr,
+                         size_t* lowerBound = nullptr, SolveBudget* budget = nullptr);
+vector<Cube> selectCover(const Cube* primes, size_t primeCount, const TruthTable& onSet,
+                         bool* provenOptimal = nullptr, size_t* lowerBound = nullptr, SolveBudget* budget = nullptr);
+
+// Primes that are the only prime on some minterm of `onSet`, found a word at a time
+vector<Cube> findEssentialPrimes(const Cube* primes, size_t primeCount, const TruthTable& onSet);
+
+// Single-word forms of selectCover() and findEssentialPrimes() for functions of
+// up to kMaxWordVariables variables, given as their truth table word. Results
+// are appended to the list and every piece of scratch comes from its arena: the
+// covering search runs on minterm bit masks instead of a covering table, so a
+// warmed-up arena serves them without heap allocations. The scratch is
+// reclaimed when the arena is rewound. The TruthTable forms above use these
+// for single-word tables.
+void selectCover(const Cube* primes, size_t primeCount, uint64_t onSet, int varCount, CubeList& cover,
+                 bool* provenOptimal = nullptr, size_t* lowerBound = nullptr, SolveBudget* budget = nullptr);
+void findEssentialPrimes(const Cube* primes, size_t primeCount, uint64_t onSet, int varCount,
+                         CubeList& essentials);
+
+// Primes of `onSet` from the primes of `oldOnSet`, the same function before an
+// edit. Old primes that are still prime are kept, and new ones are only searched
+// for around the minterms the edit gained, or lost from an old prime; a region
+// over a sixteenth of the on-set falls back to findPrimeImplicants(). Both
+// tables include the don't-cares, as for findPrimeImplicants().
+vector<Cube> repairPrimeImplicants(const vector<Cube>& oldPrimes, const TruthTable& oldOnSet,
+                                   const TruthTable& onSet);
+
+// Cover of `onSet` that keeps the cubes of `oldCover` still in `primes` and adds
+// an exact minimum cover of the minterms they miss, then drops kept cubes left
+// redundant. Irredundant, but not a proven minimum of the whole function.
+vector<Cube> repairCover(const vector<Cube>& oldCover, const vector<Cube>& primes, const TruthTable& onSet,
+                         SolveBudget* budget = nullptr);
+
+#endif // QUINE_MCCLUSKEY_HPP
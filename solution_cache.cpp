@@ -0,0 +1,227 @@
+#include "solution_cache.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char kMagic[8] = {'K', 'M', 'A', 'P', 'C', 'A', 'C', 'H'};
+static const uint32_t kVersion = 1;
+// Slots a key may occupy, starting at its home slot
+static const uint64_t kProbeWindow = 16;
+// Smallest file worth creating
+static const size_t kMinSolutionCacheBytes = size_t(1) << 20;
+static const uint32_t kProvenFlag = 1;
+
+// Shared by every process mapping the file; the counters are updated atomically
+struct SolutionCache::Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t slotBits;
+    uint64_t ringCubes;
+    uint64_t writePos; // ring position of the next cover, counted from file creation
+    uint64_t lookups;
+    uint64_t hits;
+    uint64_t reserved[2];
+};
+
+// Empty while keyLo is 0; keyLo is written last when a slot is published
+struct SolutionCache::Slot {
+    uint64_t keyLo, keyHi;
+    uint64_t position;
+    uint32_t count;
+    uint32_t flags;
+};
+
+static uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+static uint64_t load(const uint64_t& word) { return __atomic_load_n(&word, __ATOMIC_ACQUIRE); }
+static void store(uint64_t& word, uint64_t value) { __atomic_store_n(&word, value, __ATOMIC_RELEASE); }
+// Slot fields and ring cubes a writer may be replacing while a reader copies them
+template <typename T>
+static T peek(const T& word) { return __atomic_load_n(&word, __ATOMIC_RELAXED); }
+template <typename T>
+static void poke(T& word, T value) { __atomic_store_n(&word, value, __ATOMIC_RELAXED); }
+
+// Flush the pages holding [begin, begin + size) to the file
+static void syncRange(const void* begin, size_t size) {
+    uintptr_t page = sysconf(_SC_PAGESIZE);
+    uintptr_t first = reinterpret_cast<uintptr_t>(begin) & ~(page - 1);
+    msync(reinterpret_cast<void*>(first), reinterpret_cast<uintptr_t>(begin) + size - first, MS_SYNC);
+}
+
+SolutionCache::SolutionCache(const string& path, size_t capacityBytes) : base(nullptr), length(0) {
+    fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) throw std::runtime_error("Cannot open solution cache " + path);
+    flock(fd, LOCK_EX);
+
+    struct stat info;
+    fstat(fd, &info);
+    bool created = info.st_size == 0;
+    if (created) {
+        // A quarter of the file for 32-byte slots, the rest for 16-byte cubes
+        capacityBytes = std::max(capacityBytes, kMinSolutionCacheBytes);
+        uint32_t slotBits = 0;
+        while ((uint64_t(2) << slotBits) * sizeof(Slot) <= capacityBytes / 4) slotBits++;
+        uint64_t ringCubes = (capacityBytes - sizeof(Header) - (uint64_t(1) << slotBits) * sizeof(Slot)) / sizeof(Cube);
+        length = sizeof(Header) + (size_t(1) << slotBits) * sizeof(Slot) + ringCubes * sizeof(Cube);
+        if (ftruncate(fd, length) != 0) {
+            flock(fd, LOCK_UN);
+            close(fd);
+            throw std::runtime_error("Cannot size solution cache " + path);
+        }
+        Header fresh{};
+        std::memcpy(fresh.magic, kMagic, sizeof(kMagic));
+        fresh.version = kVersion;
+        fresh.slotBits = slotBits;
+        fresh.ringCubes = ringCubes;
+        if (pwrite(fd, &fresh, sizeof(fresh), 0) != static_cast<ssize_t>(sizeof(fresh))) length = 0;
+    } else {
+        length = info.st_size;
+    }
+
+    Header existing{};
+    bool valid = length >= sizeof(Header) && pread(fd, &existing, sizeof(existing), 0) == sizeof(existing) &&
+                 std::memcmp(existing.magic, kMagic, sizeof(kMagic)) == 0 && existing.version == kVersion &&
+                 existing.slotBits < 48 && existing.ringCubes > 0 &&
+                 sizeof(Header) + (uint64_t(1) << existing.slotBits) * sizeof(Slot) +
+                         existing.ringCubes * sizeof(Cube) == length;
+    if (valid) {
+        void* mapped = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED) valid = false;
+        else base = static_cast<unsigned char*>(mapped);
+    }
+    flock(fd, LOCK_UN);
+    if (!valid) {
+        close(fd);
+        throw std::runtime_error(path + " is not a solution cache file");
+    }
+
+    header = reinterpret_cast<Header*>(base);
+    slots = reinterpret_cast<Slot*>(base + sizeof(Header));
+    ring = reinterpret_cast<Cube*>(base + sizeof(Header) + (size_t(1) << header->slotBits) * sizeof(Slot));
+}
+
+SolutionCache::~SolutionCache() {
+    munmap(base, length);
+    close(fd);
+}
+
+SolutionCache::Key SolutionCache::makeKey(const TruthTable& table, uint32_t salt) {
+    uint64_t seed = (uint64_t(salt) << 8) | table.getVariableCount();
+    uint64_t lo = mix(seed ^ 0x243F6A8885A308D3ull), hi = mix(seed ^ 0x13198A2E03707344ull);
+    for (uint64_t word : table.words()) {
+        lo = mix(lo ^ word);
+        hi = mix(hi + word * 0x9E3779B97F4A7C15ull);
+    }
+    // keyLo == 0 marks an empty slot
+    return {lo | 1, hi};
+}
+
+SolutionCache::Key SolutionCache::makeKey(const TruthTable& table, const TruthTable& dontCares, uint32_t salt) {
+    Key key = makeKey(table, salt);
+    if (dontCares.getVariableCount() == 0) return key;
+    uint64_t lo = key.lo ^ 0xA4093822299F31D0ull, hi = key.hi;
+    for (uint64_t word : dontCares.words()) {
+        lo = mix(lo ^ word);
+        hi = mix(hi + word * 0x9E3779B97F4A7C15ull);
+    }
+    return {lo | 1, hi};
+}
+
+// Whether the cubes at ring positions [position, position + count) are still
+// the ones written there
+bool SolutionCache::intact(uint64_t position, uint64_t count) const {
+    uint64_t writePos = load(header->writePos);
+    return position + count <= writePos && writePos - position <= header->ringCubes;
+}
+
+bool SolutionCache::find(const Key& key, CubeList& cover, bool& provenOptimal) {
+    lookups++;
+    __atomic_fetch_add(&header->lookups, 1, __ATOMIC_RELAXED);
+    uint64_t slotMask = (uint64_t(1) << header->slotBits) - 1;
+    for (uint64_t probe = 0; probe < kProbeWindow; probe++) {
+        Slot& slot = slots[(key.lo + probe) & slotMask];
+        if (load(slot.keyLo) != key.lo || peek(slot.keyHi) != key.hi) continue;
+        uint64_t position = peek(slot.position);
+        uint32_t count = peek(slot.count), flags = peek(slot.flags);
+        if (!intact(position, count)) return false;
+
+        size_t start = cover.size();
+        uint64_t offset = position % header->ringCubes;
+        for (uint32_t i = 0; i < count; i++) {
+            const Cube& cube = ring[offset + i];
+            cover.push_back({peek(cube.mask), peek(cube.value)});
+        }
+        // Another process may have reused the cubes or the slot while they were copied
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (!intact(position, count) || load(slot.keyLo) != key.lo) {
+            while (cover.size() > start) cover.pop_back();
+            return false;
+        }
+        provenOptimal = flags & kProvenFlag;
+        hits++;
+        __atomic_fetch_add(&header->hits, 1, __ATOMIC_RELAXED);
+        return true;
+    }
+    return false;
+}
+
+void SolutionCache::insert(const Key& key, const Cube* cubes, size_t count, bool provenOptimal) {
+    uint64_t ringCubes = header->ringCubes;
+    if (count > ringCubes / 4) return; // would evict too much of the cache at once
+    std::lock_guard<std::mutex> lock(insertMutex);
+    flock(fd, LOCK_EX);
+
+    // The key's own slot, else the first empty or stale one, else the oldest
+    uint64_t slotMask = (uint64_t(1) << header->slotBits) - 1;
+    Slot *own = nullptr, *free = nullptr, *oldest = nullptr;
+    for (uint64_t probe = 0; probe < kProbeWindow && !own; probe++) {
+        Slot& slot = slots[(key.lo + probe) & slotMask];
+        uint64_t keyLo = load(slot.keyLo);
+        if (keyLo == key.lo && slot.keyHi == key.hi) own = &slot;
+        if (!free && (keyLo == 0 || !intact(slot.position, slot.count))) free = &slot;
+        if (!oldest || slot.position < oldest->position) oldest = &slot;
+    }
+    Slot* target = own ? own : free ? free : oldest;
+
+    // Reserve the cubes at the ring head, skipping the tail if they would wrap
+    uint64_t position = header->writePos;
+    if (position % ringCubes + count > ringCubes) position += ringCubes - position % ringCubes;
+    store(header->writePos, position + count);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    Cube* data = ring + position % ringCubes;
+    for (size_t i = 0; i < count; i++) {
+        poke(data[i].mask, cubes[i].mask);
+        poke(data[i].value, cubes[i].value);
+    }
+    if (count) syncRange(data, count * sizeof(Cube));
+
+    // Publish the slot, key word last
+    store(target->keyLo, 0);
+    poke(target->keyHi, key.hi);
+    poke(target->position, position);
+    poke(target->count, static_cast<uint32_t>(count));
+    poke(target->flags, provenOptimal ? kProvenFlag : 0u);
+    store(target->keyLo, key.lo);
+    syncRange(target, sizeof(Slot));
+    syncRange(header, sizeof(Header));
+    flock(fd, LOCK_UN);
+}
+
+uint64_t SolutionCache::getLifetimeHits() const {
+    return __atomic_load_n(&header->hits, __ATOMIC_RELAXED);
+}
+
+uint64_t SolutionCache::getLifetimeLookups() const {
+    return __atomic_load_n(&header->lookups, __ATOMIC_RELAXED);
+}
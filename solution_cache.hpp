@@ -0,0 +1,71 @@
+#ifndef SOLUTION_CACHE_HPP
+#define SOLUTION_CACHE_HPP
+
+#include "truth_table.hpp"
+#include "cube_arena.hpp"
+#include <atomic>
+#include <mutex>
+#include <string>
+
+using std::string;
+
+// Size a new cache file is created with
+const size_t kDefaultSolutionCacheBytes = size_t(64) << 20;
+
+// Covers persisted across runs in a memory-mapped file, keyed by a 128-bit hash
+// of the truth table and the engine that produced the cover. The file is a
+// header, an open-addressing slot table and a ring of cubes; a lookup probes a
+// fixed window of slots and copies the cubes straight out of the mapping.
+//
+// Inserts are append-only and serialized across processes with flock, and
+// between threads of this process with a mutex (flock does not exclude them):
+// cubes are reserved at the head of the ring and written (and synced) before the
+// slot that points at them is published, its first key word last, so a crash
+// leaves at worst unreferenced cubes. Once the ring wraps, the oldest covers are
+// overwritten and their slots go stale (first in, first out). Readers take no
+// lock and drop entries whose cubes were reused while they read them, so one
+// cache may be shared by concurrent solves.
+class SolutionCache {
+public:
+    struct Key {
+        uint64_t lo, hi;
+    };
+
+    // Open `path`, creating it with `capacityBytes` if it does not exist
+    explicit SolutionCache(const string& path, size_t capacityBytes = kDefaultSolutionCacheBytes);
+    ~SolutionCache();
+    SolutionCache(const SolutionCache&) = delete;
+    SolutionCache& operator=(const SolutionCache&) = delete;
+
+    // `salt` separates covers of the same table from different engines
+    static Key makeKey(const TruthTable& table, uint32_t salt);
+    // Also hashes the don't-cares; an empty `dontCares` gives the key above
+    static Key makeKey(const TruthTable& table, const TruthTable& dontCares, uint32_t salt);
+
+    // Append the cached cover to `cover`; false on a miss
+    bool find(const Key& key, CubeList& cover, bool& provenOptimal);
+    void insert(const Key& key, const Cube* cubes, size_t count, bool provenOptimal);
+
+    // Lookups of this process, and of every process since the file was created
+    uint64_t getHits() const { return hits; }
+    uint64_t getLookups() const { return lookups; }
+    uint64_t getLifetimeHits() const;
+    uint64_t getLifetimeLookups() const;
+
+private:
+    struct Header;
+    struct Slot;
+
+    bool intact(uint64_t position, uint64_t count) const;
+
+    int fd;
+    unsigned char* base;
+    size_t length;
+    Header* header;
+    Slot* slots;
+    Cube* ring;
+    std::mutex insertMutex;
+    std::atomic<uint64_t> hits{0}, lookups{0};
+};
+
+#endif // SOLUTION_CACHE_HPP
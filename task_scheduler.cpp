@@ -0,0 +1,54 @@
+#include "task_scheduler.hpp"
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct TaskQueue {
+    std::mutex lock;
+    std::deque<size_t> tasks;
+};
+
+} // namespace
+
+void runTasks(size_t taskCount, int threadCount, const std::function<void(size_t)>& task) {
+    if (threadCount <= 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+    size_t workers = std::min<size_t>(threadCount, taskCount);
+    if (workers <= 1) {
+        for (size_t t = 0; t < taskCount; t++) task(t);
+        return;
+    }
+
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+    for (size_t w = 0; w < workers; w++) queues.emplace_back(new TaskQueue());
+    for (size_t t = 0; t < taskCount; t++) queues[t % workers]->tasks.push_front(t);
+
+    // No task spawns others, so a thread whose steal attempts all fail is done
+    auto worker = [&](size_t self) {
+        while (true) {
+            size_t next = taskCount;
+            for (size_t v = 0; v < workers && next == taskCount; v++) {
+                TaskQueue& queue = *queues[(self + v) % workers];
+                std::lock_guard<std::mutex> guard(queue.lock);
+                if (queue.tasks.empty()) continue;
+                if (v == 0) {
+                    next = queue.tasks.back();
+                    queue.tasks.pop_back();
+                } else {
+                    next = queue.tasks.front();
+                    queue.tasks.pop_front();
+                }
+            }
+            if (next == taskCount) return;
+            task(next);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t w = 1; w < workers; w++) threads.emplace_back(worker, w);
+    worker(0);
+    for (auto& thread : threads) thread.join();
+}
@@ -0,0 +1,14 @@
+#ifndef TASK_SCHEDULER_HPP
+#define TASK_SCHEDULER_HPP
+
+#include <cstddef>
+#include <functional>
+
+// Run task(0) .. task(taskCount - 1) on up to `threadCount` threads (0 = one per
+// hardware thread). Tasks are dealt round-robin into per-thread deques in index
+// order; a thread works from the back of its own deque and, once it is empty,
+// steals from the front of the others. List the expensive tasks first so they
+// start early and the cheap tail evens out the load.
+void runTasks(size_t taskCount, int threadCount, const std::function<void(size_t)>& task);
+
+#endif // TASK_SCHEDULER_HPP
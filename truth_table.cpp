@@ -0,0 +1,369 @@
+#include "truth_table.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TRUTH_TABLE_X86 1
+#include <immintrin.h>
+#endif
+
+// Patterns of the six variables that vary inside a single 64-bit word
+static const uint64_t lowPatterns[6] = {
+    0xAAAAAAAAAAAAAAAAull,
+    0xCCCCCCCCCCCCCCCCull,
+    0xF0F0F0F0F0F0F0F0ull,
+    0xFF00FF00FF00FF00ull,
+    0xFFFF0000FFFF0000ull,
+    0xFFFFFFFF00000000ull
+};
+
+TruthTable::TruthTable() : varCount(0), bits(1, 0) {}
+
+TruthTable::TruthTable(int varCount)
+    : varCount(varCount), bits(varCount <= 6 ? 1 : (size_t(1) << (varCount - 6)), 0) {}
+
+uint64_t TruthTable::wordMask() const {
+    return varCount >= 6 ? ~uint64_t(0) : ((uint64_t(1) << (uint64_t(1) << varCount)) - 1);
+}
+
+uint64_t TruthTable::count() const {
+    uint64_t total = 0;
+    for (uint64_t word : bits) total += __builtin_popcountll(word);
+    return total;
+}
+
+bool TruthTable::isSubsetOf(const TruthTable& other) const {
+    for (size_t w = 0; w < bits.size(); w++) {
+        if (bits[w] & ~other.bits[w]) return false;
+    }
+    return true;
+}
+
+bool TruthTable::containsCube(const Cube& cube) const {
+    uint64_t pattern = cubeWordPattern(cube) & wordMask();
+    // Visit only the words whose index matches the cube's high variables
+    uint64_t fixed = cube.value >> 6;
+    uint64_t free = ~(cube.mask >> 6) & (bits.size() - 1);
+    uint64_t sub = 0;
+    do {
+        if (pattern & ~bits[fixed | sub]) return false;
+        sub = (sub - free) & free;
+    } while (sub != 0);
+    return true;
+}
+
+bool TruthTable::operator==(const TruthTable& other) const {
+    return varCount == other.varCount && bits == other.bits;
+}
+
+uint64_t variablePattern(int bit, size_t word) {
+    if (bit < 6) return lowPatterns[bit];
+    return ((word >> (bit - 6)) & 1) ? ~uint64_t(0) : 0;
+}
+
+uint64_t cubeWordPattern(const Cube& cube) {
+    uint64_t pattern = ~uint64_t(0);
+    for (int b = 0; b < 6; b++) {
+        if (cube.mask & (uint64_t(1) << b)) {
+            pattern &= (cube.value & (uint64_t(1) << b)) ? lowPatterns[b] : ~lowPatterns[b];
+        }
+    }
+    return pattern;
+}
+
+SimdLevel detectSimdLevel() {
+#ifdef TRUTH_TABLE_X86
+    static const SimdLevel level = __builtin_cpu_supports("avx2")     ? SimdLevel::AVX2
+                                   : __builtin_cpu_supports("sse4.2") ? SimdLevel::SSE42
+                                                                      : SimdLevel::Scalar;
+    return level;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+void forEachWordBlock(size_t wordCount, int threadCount,
+                      const std::function<void(size_t, size_t)>& body) {
+    if (threadCount <= 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+    if (threadCount == 1 || wordCount <= 8) {
+        body(0, wordCount);
+        return;
+    }
+    
+    // Aim for a few blocks per thread so uneven blocks balance out
+    size_t blockWords = 8;
+    while (blockWords * threadCount * 4 < wordCount) blockWords *= 2;
+    size_t blockCount = wordCount / blockWords;
+    
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t b = next++; b < blockCount; b = next++) {
+            body(b * blockWords, (b + 1) * blockWords);
+        }
+    };
+    vector<std::thread> threads;
+    int spawn = static_cast<int>(std::min<size_t>(threadCount, blockCount)) - 1;
+    for (int t = 0; t < spawn; t++) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+}
+
+static void evaluateScalar(const vector<Literal>& literals, const vector<uint32_t>& productEnds,
+                           TruthTable& out, size_t wordBegin, size_t wordEnd) {
+    int top = out.getVariableCount() - 1;
+    vector<uint64_t>& words = out.words();
+    for (size_t w = wordBegin; w < wordEnd; w++) {
+        uint64_t result = 0;
+        size_t begin = 0;
+        for (uint32_t end : productEnds) {
+            uint64_t term = ~uint64_t(0);
+            for (size_t i = begin; i < end; i++) {
+                uint64_t pattern = variablePattern(top - literals[i].var, w);
+                term &= literals[i].negated ? ~pattern : pattern;
+            }
+            result |= term;
+            begin = end;
+        }
+        words[w] = result & out.wordMask();
+    }
+}
+
+#ifdef TRUTH_TABLE_X86
+// Four table words per step; only used when the table has at least 4 words
+__attribute__((target("avx2")))
+static void evaluateAVX2(const vector<Literal>& literals, const vector<uint32_t>& productEnds,
+                         TruthTable& out, size_t wordBegin, size_t wordEnd) {
+    int top = out.getVariableCount() - 1;
+    vector<uint64_t>& words = out.words();
+
+    // Patterns of bits 6 and 7 vary across the four words of one block
+    __m256i patterns[8];
+    for (int b = 0; b < 6; b++) patterns[b] = _mm256_set1_epi64x(static_cast<long long>(lowPatterns[b]));
+    patterns[6] = _mm256_setr_epi64x(0, -1, 0, -1);
+    patterns[7] = _mm256_setr_epi64x(0, 0, -1, -1);
+    const __m256i ones = _mm256_set1_epi64x(-1);
+
+    for (size_t w = wordBegin; w < wordEnd; w += 4) {
+        __m256i result = _mm256_setzero_si256();
+        size_t begin = 0;
+        for (uint32_t end : productEnds) {
+            __m256i term = ones;
+            for (size_t i = begin; i < end; i++) {
+                int bit = top - literals[i].var;
+                __m256i pattern = bit < 8 ? patterns[bit]
+                                          : (((w >> (bit - 6)) & 1) ? ones : _mm256_setzero_si256());
+                term = literals[i].negated ? _mm256_andnot_si256(pattern, term)
+                                           : _mm256_and_si256(term, pattern);
+            }
+            result = _mm256_or_si256(result, term);
+            begin = end;
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&words[w]), result);
+    }
+}
+#endif
+
+void evaluateBitSliced(const vector<Literal>& literals, const vector<uint32_t>& productEnds,
+                       TruthTable& out) {
+    evaluateBitSliced(literals, productEnds, out, detectSimdLevel());
+}
+
+void evaluateBitSliced(const vector<Literal>& literals, const vector<uint32_t>& productEnds,
+                       TruthTable& out, SimdLevel level) {
+#ifdef TRUTH_TABLE_X86
+    if (level == SimdLevel::AVX2 && out.wordCount() >= 4) {
+        evaluateAVX2(literals, productEnds, out, 0, out.wordCount());
+        return;
+    }
+#endif
+    (void)level;
+    evaluateScalar(literals, productEnds, out, 0, out.wordCount());
+}
+
+void evaluateBitSliced(const vector<Literal>& literals, const vector<uint32_t>& productEnds,
+                       TruthTable& out, size_t wordBegin, size_t wordEnd) {
+#ifdef TRUTH_TABLE_X86
+    if (detectSimdLevel() == SimdLevel::AVX2 && out.wordCount() >= 4) {
+        evaluateAVX2(literals, productEnds, out, wordBegin, wordEnd);
+        return;
+    }
+#endif
+    evaluateScalar(literals, productEnds, out, wordBegin, wordEnd);
+}
+
+void evaluateGrayIncremental(const vector<Literal>& literals, const vector<uint32_t>& productEnds,
+                             TruthTable& out) {
+    evaluateGrayIncremental(literals, productEnds, out, 0, out.wordCount());
+}
+
+void evaluateGrayIncremental(const vector<Literal>& literals, const vector<uint32_t>& productEnds,
+                             TruthTable& out, size_t wordBegin, size_t wordEnd) {
+    int varCount = out.getVariableCount();
+    size_t productCount = productEnds.size();
+    
+    // The block fixes every variable above its low `walkBits` bits; walk the rest
+    int walkBits = varCount;
+    if (varCount > 6) {
+        walkBits = 6;
+        while ((size_t(1) << (walkBits - 6)) < wordEnd - wordBegin) walkBits++;
+    }
+    uint64_t base = uint64_t(wordBegin) << 6;
+
+    // Occurrence lists per variable (CSR layout): which products mention it, and how
+    vector<uint32_t> offsets(varCount + 1, 0);
+    for (const Literal& lit : literals) offsets[lit.var + 1]++;
+    for (int v = 0; v < varCount; v++) offsets[v + 1] += offsets[v];
+    vector<uint32_t> occProduct(literals.size());
+    vector<uint8_t> occNegated(literals.size());
+    vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+
+    // Start at the block's first minterm: walked variables are 0, the rest come from base
+    vector<uint8_t> values(varCount, 0);
+    for (int v = 0; v < varCount; v++) {
+        values[v] = (base >> (varCount - 1 - v)) & 1;
+    }
+    vector<uint32_t> falseCount(productCount, 0);
+    size_t begin = 0;
+    for (size_t p = 0; p < productCount; p++) {
+        for (size_t i = begin; i < productEnds[p]; i++) {
+            uint32_t slot = fill[literals[i].var]++;
+            occProduct[slot] = static_cast<uint32_t>(p);
+            occNegated[slot] = literals[i].negated;
+            if (values[literals[i].var] == literals[i].negated) falseCount[p]++;
+        }
+        begin = productEnds[p];
+    }
+    size_t active = 0;
+    for (uint32_t count : falseCount) {
+        if (count == 0) active++;
+    }
+
+    uint64_t total = uint64_t(1) << walkBits;
+    if (active > 0) out.set(base);
+    for (uint64_t i = 1; i < total; i++) {
+        // Consecutive Gray codes differ in the bit of the lowest set bit of i
+        int bit = __builtin_ctzll(i);
+        int var = varCount - 1 - bit;
+        uint8_t value = values[var] ^= 1;
+        for (uint32_t k = offsets[var]; k < offsets[var + 1]; k++) {
+            uint32_t p = occProduct[k];
+            if (value == occNegated[k]) {
+                // Literal just became false
+                if (falseCount[p]++ == 0) active--;
+            } else {
+                if (--falseCount[p] == 0) active++;
+            }
+        }
+        if (active > 0) out.set(base | (i ^ (i >> 1)));
+    }
+}
+
+vector<Cube> productsToCubes(const vector<Literal>& literals, const vector<uint32_t>& productEnds,
+                             int varCount) {
+    vector<Cube> cubes;
+    cubes.reserve(productEnds.size());
+    size_t begin = 0;
+    for (uint32_t end : productEnds) {
+        Cube cube = {0, 0};
+        bool contradictory = false;
+        for (size_t i = begin; i < end; i++) {
+            uint64_t bit = uint64_t(1) << (varCount - 1 - literals[i].var);
+            uint64_t value = literals[i].negated ? 0 : bit;
+            if ((cube.mask & bit) && (cube.value & bit) != value) {
+                contradictory = true;
+                break;
+            }
+            cube.mask |= bit;
+            cube.value |= value;
+        }
+        if (!contradictory) cubes.push_back(cube);
+        begin = end;
+    }
+    return cubes;
+}
+
+// Blocks of the 2^level minterms from `first` on: whole if every one is set,
+// else split in halves
+static void collectBlocks(const TruthTable& table, uint64_t first, int level, vector<Cube>& out) {
+    const vector<uint64_t>& words = table.words();
+    bool all = true, none = true;
+    if (level >= 6) {
+        for (size_t w = first >> 6, end = w + (size_t(1) << (level - 6)); w < end; w++) {
+            all &= words[w] == ~uint64_t(0);
+            none &= words[w] == 0;
+        }
+    } else {
+        uint64_t width = uint64_t(1) << level;
+        uint64_t bits = (words[first >> 6] >> (first & 63)) & ((uint64_t(1) << width) - 1);
+        all = bits == (uint64_t(1) << width) - 1;
+        none = bits == 0;
+    }
+    if (none) return;
+    if (all) {
+        uint64_t free = (uint64_t(1) << level) - 1;
+        out.push_back({variableMask(table.getVariableCount()) & ~free, first});
+        return;
+    }
+    collectBlocks(table, first, level - 1, out);
+    collectBlocks(table, first + (uint64_t(1) << (level - 1)), level - 1, out);
+}
+
+vector<Cube> tableToCubes(const TruthTable& table) {
+    vector<Cube> cubes;
+    collectBlocks(table, 0, table.getVariableCount(), cubes);
+    return cubes;
+}
+
+void rasterizeCubes(const vector<Cube>& cubes, TruthTable& out) {
+    rasterizeCubes(cubes, out, 0, out.wordCount());
+}
+
+void rasterizeCubes(const vector<Cube>& cubes, TruthTable& out, size_t wordBegin, size_t wordEnd) {
+    vector<uint64_t>& words = out.words();
+    // The block is aligned, so word indices inside it only vary in the low bits
+    uint64_t blockMask = wordEnd - wordBegin - 1;
+    for (const Cube& cube : cubes) {
+        uint64_t fixed = cube.value >> 6;
+        uint64_t cared = cube.mask >> 6;
+        if ((fixed ^ wordBegin) & cared & ~blockMask) continue;
+        
+        uint64_t inWord = cubeWordPattern(cube) & out.wordMask();
+
+        // Enumerate only the words whose index matches the cube's high variables
+        uint64_t first = wordBegin | (fixed & blockMask);
+        uint64_t free = ~cared & blockMask;
+        uint64_t sub = 0;
+        do {
+            words[first | sub] |= inWord;
+            sub = (sub - free) & free;
+        } while (sub != 0);
+    }
+}
+
+void clearCubes(const vector<Cube>& cubes, TruthTable& out) {
+    vector<uint64_t>& words = out.words();
+    for (const Cube& cube : cubes) {
+        uint64_t inWord = cubeWordPattern(cube) & out.wordMask();
+        uint64_t fixed = cube.value >> 6;
+        uint64_t free = ~(cube.mask >> 6) & (words.size() - 1);
+        uint64_t sub = 0;
+        do {
+            words[fixed | sub] &= ~inWord;
+            sub = (sub - free) & free;
+        } while (sub != 0);
+    }
+}
+
+bool firstDifference(const TruthTable& a, const TruthTable& b, const TruthTable& ignored, uint64_t& minterm) {
+    bool masked = ignored.getVariableCount() > 0;
+    for (size_t w = 0; w < a.wordCount(); w++) {
+        uint64_t diff = (a.words()[w] ^ b.words()[w]) & a.wordMask();
+        if (masked) diff &= ~ignored.words()[w];
+        if (diff) {
+            minterm = w * 64 + __builtin_ctzll(diff);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,172 @@
+#ifndef TRUTH_TABLE_HPP
+#define TRUTH_TABLE_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+using std::vector;
+
+// One literal of a compiled product term: index into the sorted variable list
+// plus its polarity. Variable k reads bit (varCount - 1 - k) of a minterm index.
+struct Literal {
+    uint8_t var;
+    bool negated;
+};
+
+// Product term as a cube over minterm bit positions: `mask` holds the bits the
+// cube cares about and `value` their required values (bits outside mask are 0).
+struct Cube {
+    uint64_t mask;
+    uint64_t value;
+};
+
+inline bool operator==(const Cube& a, const Cube& b) { return a.mask == b.mask && a.value == b.value; }
+inline bool operator!=(const Cube& a, const Cube& b) { return !(a == b); }
+inline bool operator<(const Cube& a, const Cube& b) {
+    return a.mask != b.mask ? a.mask < b.mask : a.value < b.value;
+}
+
+inline bool cubeContainsMinterm(const Cube& cube, uint64_t minterm) {
+    return (minterm & cube.mask) == cube.value;
+}
+
+inline bool cubeContainsCube(const Cube& outer, const Cube& inner) {
+    return (outer.mask & ~inner.mask) == 0 && ((outer.value ^ inner.value) & outer.mask) == 0;
+}
+
+// Bits that belong to minterms of an n-variable function
+inline uint64_t variableMask(int varCount) {
+    return varCount >= 64 ? ~uint64_t(0) : ((uint64_t(1) << varCount) - 1);
+}
+
+// Largest variable count for which a full truth table is materialized (2^26 bits = 8 MB)
+const int kMaxTruthTableVariables = 26;
+
+// Largest variable count whose truth table is a single word
+const int kMaxWordVariables = 6;
+
+// Bit-packed truth table: bit m of the table is the function value at minterm m.
+// Tables with fewer than 6 variables live in the low 2^n bits of a single word,
+// so a 4-variable K-map is exactly the low 16 bits of words()[0].
+class TruthTable {
+public:
+    TruthTable();
+    explicit TruthTable(int varCount);
+
+    int getVariableCount() const { return varCount; }
+    uint64_t size() const { return uint64_t(1) << varCount; }
+    size_t wordCount() const { return bits.size(); }
+
+    bool get(uint64_t minterm) const { return (bits[minterm >> 6] >> (minterm & 63)) & 1; }
+    void set(uint64_t minterm) { bits[minterm >> 6] |= uint64_t(1) << (minterm & 63); }
+
+    // Mask of the bits of a word that belong to the table (all ones for n >= 6)
+    uint64_t wordMask() const;
+
+    const vector<uint64_t>& words() const { return bits; }
+    vector<uint64_t>& words() { return bits; }
+
+    // Number of minterms set
+    uint64_t count() const;
+    // Whether every minterm of this table is set in `other` (same variable count)
+    bool isSubsetOf(const TruthTable& other) const;
+    // Whether every minterm of the cube is set; one AND-compare per word the cube spans
+    bool containsCube(const Cube& cube) const;
+
+    bool operator==(const TruthTable& other) const;
+    bool operator!=(const TruthTable& other) const { return !(*this == other); }
+
+private:
+    int varCount;
+    vector<uint64_t> bits;
+};
+
+// SIMD widths available to the vector kernels, picked once at runtime
+enum class SimdLevel {
+    Scalar,
+    SSE42,
+    AVX2
+};
+
+SimdLevel detectSimdLevel();
+
+// How the compiled equation is turned into a truth table
+enum class EvaluationMode {
+    Auto,           // pick the cheapest path for the equation (cube rasterization for SOP input)
+    CubeRaster,     // OR each product cube straight into the table, touching only its on-set
+    BitSliced,      // AND of variable pattern words, 64+ minterms per instruction
+    GrayIncremental // walk minterms in Gray code order, updating only products of the flipped variable
+};
+
+// Split the table's words into aligned power-of-two blocks of at least one cache
+// line (8 words) and run `body(wordBegin, wordEnd)` for each block on up to
+// `threadCount` threads (0 = one per hardware thread). Blocks are disjoint, so
+// evaluators can write their words without locking.
+void forEachWordBlock(size_t wordCount, int threadCount,
+                      const std::function<void(size_t, size_t)>& body);
+
+// Pattern word for variable bit position `bit` at table word `word`
+uint64_t variablePattern(int bit, size_t word);
+
+// Minterms of the cube inside any word it touches, from its six low variables
+uint64_t cubeWordPattern(const Cube& cube);
+
+// Bit-sliced evaluation: every product is an AND of variable pattern words,
+// so each instruction evaluates 64 (or 256 with AVX2) minterms at once.
+// Product p spans literals[productEnds[p-1] .. productEnds[p]).
+// The ranged overloads of every evaluator fill only words [wordBegin, wordEnd),
+// which must be a block handed out by forEachWordBlock.
+void evaluateBitSliced(const vector<Literal>& literals, const vector<uint32_t>& productEnds,
+                       TruthTable& out);
+void evaluateBitSliced(const vector<Literal>& literals, const vector<uint32_t>& productEnds,
+                       TruthTable& out, SimdLevel level);
+void evaluateBitSliced(const vector<Literal>& literals, const vector<uint32_t>& productEnds,
+                       TruthTable& out, size_t wordBegin, size_t wordEnd);
+
+// Gray-code incremental evaluation: keeps a "literals currently false" counter
+// per product and a count of active products, so each step only touches the
+// products that mention the single variable that flipped.
+void evaluateGrayIncremental(const vector<Literal>& literals, const vector<uint32_t>& productEnds,
+                             TruthTable& out);
+void evaluateGrayIncremental(const vector<Literal>& literals, const vector<uint32_t>& productEnds,
+                             TruthTable& out, size_t wordBegin, size_t wordEnd);
+
+// Convert compiled products into cubes; contradictory products (e.g. AA') are dropped
+vector<Cube> productsToCubes(const vector<Literal>& literals, const vector<uint32_t>& productEnds,
+                             int varCount);
+
+// Disjoint cubes covering exactly the minterms set in the table: the aligned
+// blocks of minterm indices that are entirely set, in minterm order
+vector<Cube> tableToCubes(const TruthTable& table);
+
+// Call body(word, pattern) for every table word the cube spans, with the
+// cube's minterms inside that word
+template <typename Body>
+void forEachCubeWord(const Cube& cube, const TruthTable& table, Body&& body) {
+    uint64_t pattern = cubeWordPattern(cube) & table.wordMask();
+    uint64_t fixed = cube.value >> 6;
+    uint64_t free = ~(cube.mask >> 6) & (table.wordCount() - 1);
+    uint64_t sub = 0;
+    do {
+        body(fixed | sub, pattern);
+        sub = (sub - free) & free;
+    } while (sub != 0);
+}
+
+// OR every cube into the table. Low variables become one in-word mask per cube and
+// only the words inside the cube are visited, so the cost follows the on-set size
+// rather than cubes x table size.
+void rasterizeCubes(const vector<Cube>& cubes, TruthTable& out);
+void rasterizeCubes(const vector<Cube>& cubes, TruthTable& out, size_t wordBegin, size_t wordEnd);
+
+// Clear every minterm of the cubes, visiting only the words inside each cube
+void clearCubes(const vector<Cube>& cubes, TruthTable& out);
+
+// Lowest minterm where two tables of the same variable count differ, ignoring
+// those set in `ignored` (empty for none); false when they agree. The scan stops
+// at the first word with a difference.
+bool firstDifference(const TruthTable& a, const TruthTable& b, const TruthTable& ignored, uint64_t& minterm);
+
+#endif // TRUTH_TABLE_HPP
@@ -0,0 +1,131 @@
+#include "zdd.hpp"
+#include "bdd.hpp"
+#include "cover_solver.hpp"
+#include <algorithm>
+#include <limits>
+
+static const size_t kMaxCacheSize = size_t(1) << 20;
+static const uint32_t kTerminalVar = std::numeric_limits<uint32_t>::max();
+
+enum ZddOp : uint32_t { OpNone, OpUnion, OpDifference };
+
+static inline uint64_t hashTriple(uint64_t a, uint64_t b, uint64_t c) {
+    uint64_t h = a * 0x9E3779B97F4A7C15ull;
+    h ^= b + 0xBF58476D1CE4E5B9ull + (h << 6) + (h >> 2);
+    h ^= c + 0x94D049BB133111EBull + (h << 6) + (h >> 2);
+    return h ^ (h >> 31);
+}
+
+Zdd::Zdd(const vector<int>& levelBits)
+    : levelBits(levelBits), unique(1024, 0), cache(1024, CacheEntry{OpNone, 0, 0, 0}) {
+    nodes.push_back({kTerminalVar, Empty, Empty});
+    nodes.push_back({kTerminalVar, Base, Base});
+}
+
+void Zdd::growUniqueTable() {
+    vector<uint32_t> grown(unique.size() * 2, 0);
+    size_t mask = grown.size() - 1;
+    for (uint32_t slot : unique) {
+        if (!slot) continue;
+        const Node& n = nodes[slot - 1];
+        size_t i = hashTriple(n.var, n.low, n.high) & mask;
+        while (grown[i]) i = (i + 1) & mask;
+        grown[i] = slot;
+    }
+    unique.swap(grown);
+    if (cache.size() < std::min(unique.size(), kMaxCacheSize)) {
+        cache.assign(std::min(unique.size(), kMaxCacheSize), CacheEntry{OpNone, 0, 0, 0});
+    }
+}
+
+Zdd::Ref Zdd::makeNode(uint32_t var, Ref low, Ref high) {
+    if (high == Empty) return low;
+    size_t mask = unique.size() - 1;
+    size_t i = hashTriple(var, low, high) & mask;
+    while (unique[i]) {
+        const Node& n = nodes[unique[i] - 1];
+        if (n.var == var && n.low == low && n.high == high) return unique[i] - 1;
+        i = (i + 1) & mask;
+    }
+    if (budget && ++sinceBudgetCheck >= kBudgetCheckInterval) {
+        sinceBudgetCheck = 0;
+        if (!budget->spend()) throw SolveBudgetExpired();
+    }
+    nodes.push_back({var, low, high});
+    unique[i] = static_cast<uint32_t>(nodes.size());
+    if (nodes.size() * 2 > unique.size()) growUniqueTable();
+    return static_cast<Ref>(nodes.size() - 1);
+}
+
+Zdd::Ref Zdd::lookup(uint32_t op, Ref f, Ref g) const {
+    const CacheEntry& entry = cache[hashTriple(op, f, g) & (cache.size() - 1)];
+    return entry.op == op && entry.f == f && entry.g == g ? entry.result : kTerminalVar;
+}
+
+void Zdd::store(uint32_t op, Ref f, Ref g, Ref result) {
+    cache[hashTriple(op, f, g) & (cache.size() - 1)] = {op, f, g, result};
+}
+
+Zdd::Ref Zdd::setUnion(Ref f, Ref g) {
+    if (f == Empty || f == g) return g;
+    if (g == Empty) return f;
+    if (f > g) std::swap(f, g);
+    Ref result = lookup(OpUnion, f, g);
+    if (result != kTerminalVar) return result;
+
+    uint32_t fv = varOf(f), gv = varOf(g);
+    if (fv < gv) {
+        result = makeNode(fv, setUnion(lowOf(f), g), highOf(f));
+    } else if (gv < fv) {
+        result = makeNode(gv, setUnion(f, lowOf(g)), highOf(g));
+    } else {
+        result = makeNode(fv, setUnion(lowOf(f), lowOf(g)), setUnion(highOf(f), highOf(g)));
+    }
+    store(OpUnion, f, g, result);
+    return result;
+}
+
+Zdd::Ref Zdd::setDifference(Ref f, Ref g) {
+    if (f == Empty || f == g) return Empty;
+    if (g == Empty) return f;
+    Ref result = lookup(OpDifference, f, g);
+    if (result != kTerminalVar) return result;
+
+    uint32_t fv = varOf(f), gv = varOf(g);
+    if (fv < gv) {
+        result = makeNode(fv, setDifference(lowOf(f), g), highOf(f));
+    } else if (gv < fv) {
+        result = setDifference(f, lowOf(g));
+    } else {
+        result = makeNode(fv, setDifference(lowOf(f), lowOf(g)), setDifference(highOf(f), highOf(g)));
+    }
+    store(OpDifference, f, g, result);
+    return result;
+}
+
+uint64_t Zdd::count(Ref f) {
+    if (f == Empty) return 0;
+    if (f == Base) return 1;
+    auto cached = counts.find(f);
+    if (cached != counts.end()) return cached->second;
+    uint64_t low = count(lowOf(f)), high = count(highOf(f));
+    uint64_t total = low + high < low ? std::numeric_limits<uint64_t>::max() : low + high;
+    counts[f] = total;
+    return total;
+}
+
+void Zdd::collectCubes(Ref f, vector<Cube>& out) const {
+    collectCubes(f, Cube{0, 0}, out);
+}
+
+void Zdd::collectCubes(Ref f, Cube prefix, vector<Cube>& out) const {
+    if (f == Empty) return;
+    if (f == Base) {
+        out.push_back(prefix);
+        return;
+    }
+    uint32_t var = varOf(f);
+    uint64_t bit = uint64_t(1) << levelBits[var / 2];
+    collectCubes(lowOf(f), prefix, out);
+    collectCubes(highOf(f), Cube{prefix.mask | bit, (var & 1) ? prefix.value : prefix.value | bit}, out);
+}
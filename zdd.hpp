@@ -0,0 +1,63 @@
+#ifndef ZDD_HPP
+#define ZDD_HPP
+
+#include "truth_table.hpp"
+#include <unordered_map>
+
+class SolveBudget;
+
+// Zero-suppressed decision diagram manager for sets of cubes. Each BDD level
+// contributes two ZDD variables, 2 * level for the positive literal and
+// 2 * level + 1 for the negative one, so a path is a set of literals (a cube)
+// and a node whose high edge leads to the empty set is never stored.
+class Zdd {
+public:
+    typedef uint32_t Ref;
+    static constexpr Ref Empty = 0; // no cubes
+    static constexpr Ref Base = 1;  // just the empty cube (the constant one)
+
+    // levelBits[level] is the minterm bit of the BDD level the literals belong to
+    explicit Zdd(const vector<int>& levelBits);
+
+    Ref makeNode(uint32_t var, Ref low, Ref high);
+    Ref setUnion(Ref f, Ref g);
+    Ref setDifference(Ref f, Ref g);
+
+    uint32_t varOf(Ref f) const { return nodes[f].var; }
+    Ref lowOf(Ref f) const { return nodes[f].low; }
+    Ref highOf(Ref f) const { return nodes[f].high; }
+
+    // Cubes in the set (saturating at UINT64_MAX) and the cubes themselves
+    uint64_t count(Ref f);
+    void collectCubes(Ref f, vector<Cube>& out) const;
+
+    size_t nodeCount() const { return nodes.size(); }
+    // Spends a step of `budget` every kBudgetCheckInterval nodes, as Bdd does,
+    // and throws SolveBudgetExpired once it runs out
+    void setBudget(SolveBudget* budget) { this->budget = budget; }
+
+private:
+    struct Node {
+        uint32_t var;
+        Ref low, high;
+    };
+    struct CacheEntry {
+        uint32_t op;
+        Ref f, g, result;
+    };
+
+    Ref lookup(uint32_t op, Ref f, Ref g) const;
+    void store(uint32_t op, Ref f, Ref g, Ref result);
+    void growUniqueTable();
+    void collectCubes(Ref f, Cube prefix, vector<Cube>& out) const;
+
+    vector<int> levelBits;
+    vector<Node> nodes;
+    vector<uint32_t> unique;   // open addressing, node index + 1 (0 = empty)
+    vector<CacheEntry> cache;  // direct mapped computed table shared by all operations
+    std::unordered_map<Ref, uint64_t> counts;
+    SolveBudget* budget = nullptr;
+    uint32_t sinceBudgetCheck = 0;
+};
+
+#endif // ZDD_HPP